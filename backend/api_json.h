@@ -0,0 +1,55 @@
+#ifndef API_JSON_H
+#define API_JSON_H
+
+#include "json_writer.h"
+#include "models.h"
+#include "prediction.h"
+#include <vector>
+
+// Представление объектов API в JSON (общее для всех обработчиков)
+namespace ApiJson {
+    inline void write(JsonWriter& w, const Student& s) {
+        w.beginObject()
+            .field("id", s.id)
+            .field("name", s.name)
+            .field("surname", s.surname)
+            .field("group_name", s.group_name)
+            .endObject();
+    }
+
+    inline void write(JsonWriter& w, const Grade& g) {
+        w.beginObject()
+            .field("id", g.id)
+            .field("student_id", g.student_id)
+            .field("subject", g.subject)
+            .field("grade", g.grade)
+            .field("semester", g.semester)
+            .field("attendance_percent", g.attendance_percent)
+            .field("assignment_completion", g.assignment_completion)
+            .field("exam_result", g.exam_result)
+            .endObject();
+    }
+
+    inline void write(JsonWriter& w, const Prediction& p) {
+        w.beginObject()
+            .field("student_id", p.student_id)
+            .field("has_data", p.has_data)
+            .field("score", p.score)
+            .field("predicted_grade", p.predicted_grade)
+            .field("label", p.has_data ? Predictor::label(p.predicted_grade) : std::string())
+            .field("probability", p.probability)
+            .endObject();
+    }
+
+    // Массив объектов
+    template<typename T>
+    void writeArray(JsonWriter& w, const std::vector<T>& items) {
+        w.beginArray();
+        for (const auto& item : items) {
+            write(w, item);
+        }
+        w.endArray();
+    }
+}
+
+#endif
@@ -0,0 +1,126 @@
+#include "change_listener.h"
+#include "log.h"
+#include <pqxx/pqxx>
+#include <chrono>
+#include <charconv>
+#include <utility>
+
+namespace {
+    class Receiver : public pqxx::notification_receiver {
+    private:
+        const ChangeListener::ChangeHandler& handler;
+        const ChangeListener::ResyncHandler& resync;
+
+    public:
+        Receiver(pqxx::connection& conn, const std::string& channel, const ChangeListener::ChangeHandler& handler,
+                 const ChangeListener::ResyncHandler& resync)
+            : pqxx::notification_receiver(conn, channel), handler(handler), resync(resync) {}
+
+        void operator()(const std::string& payload, int) override {
+            DataChange change;
+            if (!ChangeListener::parse(payload, change)) {
+                LOG_WARN("Change listener: unrecognized notification", {{"payload", payload}});
+                return;
+            }
+            try {
+                handler(change);
+            } catch (const std::exception& e) {
+                LOG_ERROR("Change listener: failed to apply notification", {{"payload", payload}, {"error", e.what()}});
+                // Какая строка изменилась, известно, но прочитать ее не удалось - перечитать все
+                if (resync) {
+                    resync();
+                }
+            }
+        }
+    };
+}
+
+ChangeListener::ChangeListener(const std::string& conn_str, const std::string& channel,
+                               ChangeHandler on_change, ResyncHandler on_resync)
+    : connection_string(conn_str), channel(channel),
+      on_change(std::move(on_change)), on_resync(std::move(on_resync)) {}
+
+ChangeListener::~ChangeListener() {
+    stop();
+}
+
+void ChangeListener::start() {
+    if (running.exchange(true)) {
+        return;
+    }
+    worker = std::thread(&ChangeListener::run, this);
+}
+
+void ChangeListener::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex);
+        running = false;
+    }
+    stop_cv.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool ChangeListener::parse(const std::string& payload, DataChange& change) {
+    // Поля через ':'; экземпляр и транзакция необязательны
+    std::string fields[5];
+    size_t count = 0;
+    size_t pos = 0;
+    while (count < 5) {
+        size_t end = payload.find(':', pos);
+        fields[count++] = payload.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+        if (end == std::string::npos) {
+            break;
+        }
+        pos = end + 1;
+        if (count == 5) {
+            return false;
+        }
+    }
+    if (count < 3) {
+        return false;
+    }
+    change.table = fields[0];
+    change.operation = fields[1];
+    change.origin = fields[3];
+    change.txid = 0;
+    const std::string& id = fields[2];
+    auto result = std::from_chars(id.data(), id.data() + id.size(), change.id);
+    if (result.ec != std::errc() || result.ptr != id.data() + id.size() || id.empty()) {
+        return false;
+    }
+    if (count == 5) {
+        const std::string& txid = fields[4];
+        result = std::from_chars(txid.data(), txid.data() + txid.size(), change.txid);
+        if (result.ec != std::errc() || result.ptr != txid.data() + txid.size() || txid.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ChangeListener::run() {
+    while (running) {
+        try {
+            pqxx::connection conn(connection_string);
+            Receiver receiver(conn, channel, on_change, on_resync);
+            LOG_INFO("Change listener: LISTEN", {{"channel", channel}});
+
+            if (on_resync) {
+                on_resync();
+            }
+
+            // Ждем уведомления с таймаутом, чтобы вовремя заметить остановку
+            while (running) {
+                conn.await_notification(1, 0);
+            }
+        } catch (const std::exception& e) {
+            LOG_WARN("Change listener: connection lost", {{"error", e.what()}});
+        }
+
+        // Пауза перед переподключением (прерывается при остановке)
+        std::unique_lock<std::mutex> lock(stop_mutex);
+        stop_cv.wait_for(lock, std::chrono::seconds(1), [this] { return !running; });
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef CHANGE_LISTENER_H
+#define CHANGE_LISTENER_H
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+
+// Изменение строки, о котором сообщил триггер notify_data_change (database/init.sql)
+struct DataChange {
+    std::string table;      // students или student_grades
+    std::string operation;  // INSERT, UPDATE, DELETE, TRUNCATE или RELOAD (после массового импорта)
+    int id = 0;             // id измененной строки (0 для TRUNCATE)
+    std::string origin;     // Экземпляр сервера, сделавший изменение (пусто - не сервер)
+    int64_t txid = 0;       // Транзакция изменения (txid_current(); 0 - не указана)
+};
+
+// Фоновый поток, который держит отдельное соединение с БД, выполняет LISTEN
+// на канале и передает каждое уведомление обработчику.
+// После каждого (пере)подключения вызывается on_resync: уведомления, пришедшие
+// пока соединения не было, потеряны, и кэш нужно перечитать. То же - если обработчик
+// бросил исключение (например, не смог перечитать строку): изменение иначе было бы потеряно.
+class ChangeListener {
+public:
+    using ChangeHandler = std::function<void(const DataChange&)>;
+    using ResyncHandler = std::function<void()>;
+
+private:
+    std::string connection_string;
+    std::string channel;
+    ChangeHandler on_change;
+    ResyncHandler on_resync;
+
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::mutex stop_mutex;
+    std::condition_variable stop_cv;
+
+    void run();
+
+public:
+    ChangeListener(const std::string& conn_str, const std::string& channel,
+                   ChangeHandler on_change, ResyncHandler on_resync);
+    ~ChangeListener();
+
+    ChangeListener(const ChangeListener&) = delete;
+    ChangeListener& operator=(const ChangeListener&) = delete;
+
+    void start();
+    void stop();
+
+    // Разбор сообщения вида "<таблица>:<операция>:<id>[:<экземпляр>[:<транзакция>]]"
+    static bool parse(const std::string& payload, DataChange& change);
+};
+
+#endif
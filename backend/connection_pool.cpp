@@ -0,0 +1,177 @@
+#include "connection_pool.h"
+#include "metrics.h"
+#include "log.h"
+#include <utility>
+
+ConnectionPool::Lease::Lease(ConnectionPool* pool, std::unique_ptr<pqxx::connection> conn)
+    : pool(pool), conn(std::move(conn)) {}
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool(other.pool), conn(std::move(other.conn)), broken(other.broken) {
+    other.pool = nullptr;
+}
+
+ConnectionPool::Lease::~Lease() {
+    if (pool && conn) {
+        pool->release(std::move(conn), broken);
+    }
+}
+
+ConnectionPool::ConnectionPool(const std::string& conn_str, const PoolConfig& config, ConnectHook on_connect)
+    : connection_string(conn_str), config(config), on_connect(std::move(on_connect)) {
+    if (this->config.max_size == 0) {
+        this->config.max_size = 1;
+    }
+    if (this->config.min_size > this->config.max_size) {
+        this->config.min_size = this->config.max_size;
+    }
+
+    // Открываем минимальное число соединений заранее. Если БД еще недоступна,
+    // соединения будут открыты позже, при первых запросах
+    for (size_t i = 0; i < this->config.min_size; i++) {
+        try {
+            idle.push_back(Slot{connect(), std::chrono::steady_clock::now()});
+            total++;
+        } catch (const std::exception& e) {
+            LOG_ERROR("Connection pool: failed to open connection at startup", {{"error", e.what()}});
+            break;
+        }
+    }
+    LOG_INFO("Connection pool: connections opened",
+             {{"open", total}, {"min", this->config.min_size}, {"max", this->config.max_size}});
+}
+
+ConnectionPool::~ConnectionPool() {
+    std::lock_guard<std::mutex> lock(mutex);
+    idle.clear();
+}
+
+std::unique_ptr<pqxx::connection> ConnectionPool::connect() {
+    uint64_t start = Metrics::now();
+    try {
+        auto conn = std::make_unique<pqxx::connection>(connection_string);
+        if (on_connect) {
+            on_connect(*conn);
+        }
+        Metrics::recordConnect(Metrics::now() - start, false);
+        return conn;
+    } catch (...) {
+        Metrics::recordConnect(Metrics::now() - start, true);
+        throw;
+    }
+}
+
+bool ConnectionPool::isHealthy(Slot& slot) {
+    if (!slot.conn || !slot.conn->is_open()) {
+        return false;
+    }
+    // Долго простоявшее соединение могло быть закрыто сервером или сетью
+    if (std::chrono::steady_clock::now() - slot.last_used < config.health_check_idle) {
+        return true;
+    }
+    try {
+        pqxx::nontransaction txn(*slot.conn);
+        txn.exec("SELECT 1");
+        return true;
+    } catch (const std::exception& e) {
+        LOG_WARN("Connection pool: connection check failed", {{"error", e.what()}});
+        return false;
+    }
+}
+
+ConnectionPool::Lease ConnectionPool::acquire() {
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + config.checkout_timeout;
+    bool waited = false;
+
+    auto finish = [&](std::unique_ptr<pqxx::connection> conn) {
+        checkouts++;
+        if (waited) {
+            waits++;
+            wait_time_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        }
+        return Lease(this, std::move(conn));
+    };
+
+    // Открыть новое соединение вместо отсутствующего; место в total уже занято
+    auto open = [&](std::unique_lock<std::mutex>& lock) {
+        try {
+            return connect();
+        } catch (...) {
+            lock.lock();
+            total--;
+            available.notify_one();
+            throw;
+        }
+    };
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        if (!idle.empty()) {
+            Slot slot = std::move(idle.back());
+            idle.pop_back();
+            lock.unlock();
+
+            if (isHealthy(slot)) {
+                return finish(std::move(slot.conn));
+            }
+
+            // Соединение умерло - пересоздаем его на том же месте
+            reconnects++;
+            slot.conn.reset();
+            LOG_WARN("Connection pool: reconnecting to database");
+            return finish(open(lock));
+        }
+
+        if (total < config.max_size) {
+            total++;
+            lock.unlock();
+            return finish(open(lock));
+        }
+
+        waited = true;
+        if (available.wait_until(lock, deadline) == std::cv_status::timeout &&
+            idle.empty() && total >= config.max_size) {
+            timeouts++;
+            waits++;
+            wait_time_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            throw PoolTimeout("Connection pool: нет свободных соединений");
+        }
+    }
+}
+
+void ConnectionPool::release(std::unique_ptr<pqxx::connection> conn, bool broken) {
+    if (broken || !conn->is_open()) {
+        // Не возвращаем сломанное соединение: следующий acquire откроет новое
+        conn.reset();
+        reconnects++;
+        std::lock_guard<std::mutex> lock(mutex);
+        total--;
+        available.notify_one();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(Slot{std::move(conn), std::chrono::steady_clock::now()});
+    }
+    available.notify_one();
+}
+
+PoolStats ConnectionPool::stats() const {
+    PoolStats s;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        s.total = total;
+        s.idle = idle.size();
+    }
+    s.in_use = s.total - s.idle;
+    s.checkouts = checkouts;
+    s.waits = waits;
+    s.wait_time_us = wait_time_us;
+    s.timeouts = timeouts;
+    s.reconnects = reconnects;
+    return s;
+}
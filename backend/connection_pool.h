@@ -0,0 +1,107 @@
+#ifndef CONNECTION_POOL_H
+#define CONNECTION_POOL_H
+
+#include <pqxx/pqxx>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <functional>
+
+// Настройки пула соединений
+struct PoolConfig {
+    size_t min_size = 2;                                  // Соединений, открываемых заранее
+    size_t max_size = 10;                                 // Верхняя граница числа соединений
+    std::chrono::milliseconds checkout_timeout{5000};     // Сколько ждать свободное соединение
+    std::chrono::milliseconds health_check_idle{30000};   // После такого простоя соединение проверяется запросом
+};
+
+// Счетчики пула (снимок на момент вызова)
+struct PoolStats {
+    size_t total = 0;           // Открытых соединений
+    size_t idle = 0;            // Свободных
+    size_t in_use = 0;          // Выданных
+    uint64_t checkouts = 0;     // Всего выдач
+    uint64_t waits = 0;         // Выдач, которым пришлось ждать
+    uint64_t wait_time_us = 0;  // Суммарное время ожидания (мкс)
+    uint64_t timeouts = 0;      // Выдач, не дождавшихся соединения
+    uint64_t reconnects = 0;    // Соединений, пересозданных после сбоя
+};
+
+// Соединение не удалось получить за checkout_timeout
+class PoolTimeout : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+class ConnectionPool {
+public:
+    // Вызывается для каждого нового соединения (например, чтобы подготовить запросы)
+    using ConnectHook = std::function<void(pqxx::connection&)>;
+
+private:
+    struct Slot {
+        std::unique_ptr<pqxx::connection> conn;
+        std::chrono::steady_clock::time_point last_used;
+    };
+
+    std::string connection_string;
+    PoolConfig config;
+    ConnectHook on_connect;
+
+    mutable std::mutex mutex;
+    std::condition_variable available;
+    std::vector<Slot> idle;     // Свободные соединения (LIFO - "горячие" сверху)
+    size_t total = 0;           // Открытые + создаваемые прямо сейчас
+
+    std::atomic<uint64_t> checkouts{0};
+    std::atomic<uint64_t> waits{0};
+    std::atomic<uint64_t> wait_time_us{0};
+    std::atomic<uint64_t> timeouts{0};
+    std::atomic<uint64_t> reconnects{0};
+
+    std::unique_ptr<pqxx::connection> connect();
+    bool isHealthy(Slot& slot);
+    void release(std::unique_ptr<pqxx::connection> conn, bool broken);
+
+public:
+    // Соединение, взятое из пула; возвращается в пул в деструкторе
+    class Lease {
+    private:
+        ConnectionPool* pool;
+        std::unique_ptr<pqxx::connection> conn;
+        bool broken = false;
+
+    public:
+        Lease(ConnectionPool* pool, std::unique_ptr<pqxx::connection> conn);
+        Lease(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease();
+
+        pqxx::connection& operator*() { return *conn; }
+        pqxx::connection* operator->() { return conn.get(); }
+
+        // Соединение не вернется в пул, вместо него будет открыто новое
+        void markBroken() { broken = true; }
+    };
+
+    ConnectionPool(const std::string& conn_str, const PoolConfig& config, ConnectHook on_connect = nullptr);
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // Взять соединение; бросает PoolTimeout, если свободного нет дольше checkout_timeout
+    Lease acquire();
+
+    PoolStats stats() const;
+};
+
+#endif
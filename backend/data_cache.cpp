@@ -0,0 +1,372 @@
+#include "data_cache.h"
+#include <algorithm>
+#include <utility>
+#include <random>
+
+namespace {
+    // Порядок оценок внутри одного студента (как ORDER BY semester, subject, id)
+    bool gradeBefore(const Grade& a, const Grade& b) {
+        if (a.semester != b.semester) {
+            return a.semester < b.semester;
+        }
+        if (a.subject != b.subject) {
+            return a.subject < b.subject;
+        }
+        return a.id < b.id;
+    }
+
+    bool studentBefore(const Student& s, int id) {
+        return s.id < id;
+    }
+
+    // Номер группы для id (SERIAL, неотрицательные; отрицательные - в первой группе)
+    size_t shardIndex(int id, int width) {
+        return id < 0 ? 0 : (size_t)id / (size_t)width;
+    }
+
+    // Пересчитать суммы студента по его строкам. Суммирование в порядке строк дает
+    // побитово тот же результат, что и расчет прогноза по getStudentGrades, без кэша
+    // и в predictAll. Строки студента при изменении и так копируются, поэтому пересчет
+    // на каждое изменение не меняет сложность; разница сумм (+/-) накапливала бы ошибку
+    // округления и на границах оценок давала бы другой прогноз
+    void refreshAggregate(StudentGrades& student) {
+        StudentAggregate aggregate;
+        for (const auto& g : student.grades) {
+            aggregate.sum_grade += g.grade;
+            aggregate.sum_attendance += g.attendance_percent;
+            aggregate.sum_assignment += g.assignment_completion;
+            aggregate.count++;
+        }
+        student.aggregate = aggregate;
+    }
+
+    // Копия оценок студента для изменения (пустая, если оценок еще нет)
+    std::shared_ptr<StudentGrades> copyStudent(const GradesSnapshot& snapshot, int student_id) {
+        const StudentGrades* current = snapshot.find(student_id);
+        return current ? std::make_shared<StudentGrades>(*current) : std::make_shared<StudentGrades>();
+    }
+
+    // Заменить оценки студента в снимке (пустые - убрать студента): копируется одна группа
+    void putStudent(GradesSnapshot& snapshot, int student_id, std::shared_ptr<const StudentGrades> student) {
+        size_t index = shardIndex(student_id, CACHE_SHARD_IDS);
+        if (index >= snapshot.shards.size()) {
+            if (student->grades.empty()) {
+                return;
+            }
+            snapshot.shards.resize(index + 1);
+        }
+        const auto& current = snapshot.shards[index];
+        auto shard = current ? std::make_shared<GradesSnapshot::Shard>(*current)
+                             : std::make_shared<GradesSnapshot::Shard>();
+        if (student->grades.empty()) {
+            shard->erase(student_id);
+        } else {
+            (*shard)[student_id] = std::move(student);
+        }
+        snapshot.shards[index] = shard->empty() ? nullptr : std::shared_ptr<const GradesSnapshot::Shard>(std::move(shard));
+    }
+
+    // Запомнить владельца оценки (NO_STUDENT - оценки больше нет)
+    void setOwner(GradesSnapshot& snapshot, int grade_id, int student_id) {
+        if (grade_id < 0) {
+            return;     // Не индексируются, ownerOf ищет их перебором
+        }
+        size_t index = (size_t)grade_id / GradesSnapshot::OWNER_SHARD_IDS;
+        if (index >= snapshot.owners.size()) {
+            if (student_id == GradesSnapshot::NO_STUDENT) {
+                return;
+            }
+            snapshot.owners.resize(index + 1);
+        }
+        const auto& current = snapshot.owners[index];
+        std::shared_ptr<GradesSnapshot::Owners> owners;
+        if (current) {
+            owners = std::make_shared<GradesSnapshot::Owners>(*current);
+        } else {
+            owners = std::make_shared<GradesSnapshot::Owners>();
+            owners->fill(GradesSnapshot::NO_STUDENT);
+        }
+        (*owners)[(size_t)grade_id % GradesSnapshot::OWNER_SHARD_IDS] = student_id;
+        snapshot.owners[index] = std::move(owners);
+    }
+
+    // Убрать строку id из оценок студента; false, если ее там нет
+    bool eraseGrade(StudentGrades& student, int id) {
+        auto it = std::find_if(student.grades.begin(), student.grades.end(), [id](const Grade& g) { return g.id == id; });
+        if (it == student.grades.end()) {
+            return false;
+        }
+        student.grades.erase(it);
+        return true;
+    }
+
+    void insertGrade(StudentGrades& student, const Grade& grade) {
+        auto pos = std::find_if(student.grades.begin(), student.grades.end(),
+                                [&](const Grade& g) { return gradeBefore(grade, g); });
+        student.grades.insert(pos, grade);
+    }
+
+    std::shared_ptr<StudentsSnapshot> buildStudents(std::vector<Student> list) {
+        std::sort(list.begin(), list.end(), [](const Student& a, const Student& b) { return a.id < b.id; });
+        auto snapshot = std::make_shared<StudentsSnapshot>();
+        snapshot->count = list.size();
+        std::shared_ptr<StudentsSnapshot::Shard> shard;
+        size_t shard_index = 0;
+        for (auto& student : list) {
+            size_t index = shardIndex(student.id, CACHE_SHARD_IDS);
+            if (!shard || index != shard_index) {
+                if (shard) {
+                    snapshot->shards[shard_index] = std::move(shard);
+                }
+                shard = std::make_shared<StudentsSnapshot::Shard>();
+                shard_index = index;
+                snapshot->shards.resize(index + 1);
+            }
+            shard->push_back(std::move(student));
+        }
+        if (shard) {
+            snapshot->shards[shard_index] = std::move(shard);
+        }
+        return snapshot;
+    }
+
+    // Строки одного студента в list идут в порядке semester, subject, id (как GET_ALL_GRADES)
+    std::shared_ptr<GradesSnapshot> buildGrades(std::vector<Grade> list) {
+        std::map<int, std::shared_ptr<StudentGrades>> by_student;
+        for (auto& g : list) {
+            auto& student = by_student[g.student_id];
+            if (!student) {
+                student = std::make_shared<StudentGrades>();
+            }
+            student->grades.push_back(std::move(g));
+        }
+
+        auto snapshot = std::make_shared<GradesSnapshot>();
+        snapshot->count = list.size();
+        std::shared_ptr<GradesSnapshot::Shard> shard;
+        size_t shard_index = 0;
+        for (auto& entry : by_student) {
+            refreshAggregate(*entry.second);
+            for (const auto& g : entry.second->grades) {
+                setOwner(*snapshot, g.id, entry.first);
+            }
+            size_t index = shardIndex(entry.first, CACHE_SHARD_IDS);
+            if (!shard || index != shard_index) {
+                if (shard) {
+                    snapshot->shards[shard_index] = std::move(shard);
+                }
+                shard = std::make_shared<GradesSnapshot::Shard>();
+                shard_index = index;
+                snapshot->shards.resize(index + 1);
+            }
+            shard->emplace(entry.first, std::move(entry.second));
+        }
+        if (shard) {
+            snapshot->shards[shard_index] = std::move(shard);
+        }
+        return snapshot;
+    }
+}
+
+const StudentGrades* GradesSnapshot::find(int student_id) const {
+    size_t index = shardIndex(student_id, CACHE_SHARD_IDS);
+    if (index >= shards.size() || !shards[index]) {
+        return nullptr;
+    }
+    auto it = shards[index]->find(student_id);
+    return it == shards[index]->end() ? nullptr : it->second.get();
+}
+
+bool GradesSnapshot::ownerOf(int grade_id, int& student_id) const {
+    if (grade_id < 0) {
+        bool found = false;
+        forEach([&](const Grade& g) {
+            if (g.id == grade_id) {
+                student_id = g.student_id;
+                found = true;
+            }
+            return !found;
+        });
+        return found;
+    }
+    size_t index = (size_t)grade_id / OWNER_SHARD_IDS;
+    if (index >= owners.size() || !owners[index]) {
+        return false;
+    }
+    student_id = (*owners[index])[(size_t)grade_id % OWNER_SHARD_IDS];
+    return student_id != NO_STUDENT;
+}
+
+DataCache::DataCache() : epoch(std::random_device{}() ^ ((uint64_t)std::random_device{}() << 32)) {}
+
+void DataCache::storeStudents(std::shared_ptr<StudentsSnapshot> snapshot) {
+    snapshot->version = ++version;
+    std::atomic_store(&students, std::shared_ptr<const StudentsSnapshot>(std::move(snapshot)));
+}
+
+void DataCache::storeGrades(std::shared_ptr<GradesSnapshot> snapshot) {
+    snapshot->version = ++version;
+    std::atomic_store(&grades, std::shared_ptr<const GradesSnapshot>(std::move(snapshot)));
+}
+
+std::shared_ptr<const StudentsSnapshot> DataCache::getStudents(const StudentsLoader& loader) {
+    auto current = std::atomic_load(&students);
+    if (current) {
+        return current;
+    }
+
+    // Загрузка под мьютексом писателей: запись, закоммиченная во время загрузки,
+    // применится к снимку уже после его публикации
+    std::lock_guard<std::mutex> lock(write_mutex);
+    current = std::atomic_load(&students);
+    if (!current) {
+        storeStudents(buildStudents(loader()));
+        current = std::atomic_load(&students);
+    }
+    return current;
+}
+
+std::shared_ptr<const GradesSnapshot> DataCache::getGrades(const GradesLoader& loader) {
+    auto current = std::atomic_load(&grades);
+    if (current) {
+        return current;
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex);
+    current = std::atomic_load(&grades);
+    if (!current) {
+        storeGrades(buildGrades(loader()));
+        current = std::atomic_load(&grades);
+    }
+    return current;
+}
+
+void DataCache::upsertStudent(const Student& student) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    auto current = std::atomic_load(&students);
+    if (!current) {
+        // Снимок еще не загружен - загрузка увидит запись сама
+        version++;
+        return;
+    }
+
+    auto next = std::make_shared<StudentsSnapshot>(*current);
+    size_t index = shardIndex(student.id, CACHE_SHARD_IDS);
+    if (index >= next->shards.size()) {
+        next->shards.resize(index + 1);
+    }
+    auto shard = next->shards[index] ? std::make_shared<StudentsSnapshot::Shard>(*next->shards[index])
+                                     : std::make_shared<StudentsSnapshot::Shard>();
+    auto it = std::lower_bound(shard->begin(), shard->end(), student.id, studentBefore);
+    if (it != shard->end() && it->id == student.id) {
+        *it = student;
+    } else {
+        shard->insert(it, student);
+        next->count++;
+    }
+    next->shards[index] = std::move(shard);
+    storeStudents(std::move(next));
+}
+
+void DataCache::removeStudent(int id) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    version++;
+
+    auto currentStudents = std::atomic_load(&students);
+    size_t index = shardIndex(id, CACHE_SHARD_IDS);
+    if (currentStudents && index < currentStudents->shards.size() && currentStudents->shards[index]) {
+        const auto& current = *currentStudents->shards[index];
+        auto it = std::lower_bound(current.begin(), current.end(), id, studentBefore);
+        if (it != current.end() && it->id == id) {
+            auto next = std::make_shared<StudentsSnapshot>(*currentStudents);
+            auto shard = std::make_shared<StudentsSnapshot::Shard>(current);
+            shard->erase(shard->begin() + (it - current.begin()));
+            next->shards[index] = shard->empty() ? nullptr : std::shared_ptr<const StudentsSnapshot::Shard>(std::move(shard));
+            next->count--;
+            storeStudents(std::move(next));
+        }
+    }
+
+    auto currentGrades = std::atomic_load(&grades);
+    const StudentGrades* removed = currentGrades ? currentGrades->find(id) : nullptr;
+    if (removed) {
+        auto next = std::make_shared<GradesSnapshot>(*currentGrades);
+        for (const auto& g : removed->grades) {
+            setOwner(*next, g.id, GradesSnapshot::NO_STUDENT);
+        }
+        next->count -= removed->grades.size();
+        putStudent(*next, id, std::make_shared<StudentGrades>());
+        storeGrades(std::move(next));
+    }
+}
+
+void DataCache::upsertGrade(const Grade& grade) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    auto current = std::atomic_load(&grades);
+    if (!current) {
+        version++;
+        return;
+    }
+
+    auto next = std::make_shared<GradesSnapshot>(*current);
+
+    // Старая версия строки могла принадлежать другому студенту
+    int old_student_id = GradesSnapshot::NO_STUDENT;
+    bool existed = current->ownerOf(grade.id, old_student_id);
+    if (existed && old_student_id != grade.student_id) {
+        auto old_student = copyStudent(*current, old_student_id);
+        eraseGrade(*old_student, grade.id);
+        refreshAggregate(*old_student);
+        putStudent(*next, old_student_id, std::move(old_student));
+    }
+
+    auto student = copyStudent(*current, grade.student_id);
+    if (existed) {
+        eraseGrade(*student, grade.id);
+    } else {
+        next->count++;
+    }
+    insertGrade(*student, grade);
+    refreshAggregate(*student);
+    putStudent(*next, grade.student_id, std::move(student));
+    setOwner(*next, grade.id, grade.student_id);
+    storeGrades(std::move(next));
+}
+
+void DataCache::removeGrade(int id) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    auto current = std::atomic_load(&grades);
+    if (!current) {
+        version++;
+        return;
+    }
+
+    int student_id = GradesSnapshot::NO_STUDENT;
+    if (!current->ownerOf(id, student_id)) {
+        return;
+    }
+    auto next = std::make_shared<GradesSnapshot>(*current);
+    auto student = copyStudent(*current, student_id);
+    if (eraseGrade(*student, id)) {
+        next->count--;
+    }
+    refreshAggregate(*student);
+    putStudent(*next, student_id, std::move(student));
+    setOwner(*next, id, GradesSnapshot::NO_STUDENT);
+    storeGrades(std::move(next));
+}
+
+std::shared_ptr<const StudentsSnapshot> DataCache::makeStudentsSnapshot(std::vector<Student> list) {
+    return buildStudents(std::move(list));
+}
+
+std::shared_ptr<const GradesSnapshot> DataCache::makeGradesSnapshot(std::vector<Grade> list) {
+    return buildGrades(std::move(list));
+}
+
+void DataCache::invalidate() {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    version++;
+    std::atomic_store(&students, std::shared_ptr<const StudentsSnapshot>());
+    std::atomic_store(&grades, std::shared_ptr<const GradesSnapshot>());
+}
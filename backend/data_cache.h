@@ -0,0 +1,144 @@
+#ifndef DATA_CACHE_H
+#define DATA_CACHE_H
+
+#include "models.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <map>
+#include <array>
+
+// Снимки разбиты на группы по диапазонам id (CACHE_SHARD_IDS подряд идущих id в группе).
+// Изменение одной строки копирует список указателей на группы и одну группу,
+// а не всю таблицу; остальные группы новый снимок делит со старым
+const int CACHE_SHARD_IDS = 256;
+
+// Неизменяемый снимок таблицы students
+struct StudentsSnapshot {
+    using Shard = std::vector<Student>;     // Студенты одного диапазона id, по возрастанию id
+
+    uint64_t version = 0;
+    size_t count = 0;
+    std::vector<std::shared_ptr<const Shard>> shards;   // nullptr - в диапазоне нет студентов
+
+    // Обход по возрастанию id; visit возвращает false, чтобы прервать обход
+    template<typename Visit>
+    void forEach(const Visit& visit) const {
+        for (const auto& shard : shards) {
+            if (!shard) {
+                continue;
+            }
+            for (const Student& student : *shard) {
+                if (!visit(student)) {
+                    return;
+                }
+            }
+        }
+    }
+};
+
+// Суммы показателей по всем оценкам одного студента (для прогноза за O(1))
+struct StudentAggregate {
+    double sum_grade = 0.0;
+    double sum_attendance = 0.0;
+    double sum_assignment = 0.0;
+    int count = 0;
+};
+
+// Оценки одного студента (по semester, subject, id - как GET_ALL_GRADES) и суммы по ним.
+// Изменение оценки копирует только этот объект, и суммы пересчитываются по строкам
+// в этом порядке - так же, как их считает прогноз без кэша
+struct StudentGrades {
+    std::vector<Grade> grades;
+    StudentAggregate aggregate;
+};
+
+// Неизменяемый снимок таблицы student_grades
+struct GradesSnapshot {
+    static constexpr int OWNER_SHARD_IDS = 1024;
+    static constexpr int NO_STUDENT = INT32_MIN;
+
+    using Shard = std::map<int, std::shared_ptr<const StudentGrades>>;   // student_id -> оценки
+    using Owners = std::array<int, OWNER_SHARD_IDS>;                      // id оценки -> student_id
+
+    uint64_t version = 0;
+    size_t count = 0;
+    std::vector<std::shared_ptr<const Shard>> shards;   // Группы по student_id
+    std::vector<std::shared_ptr<const Owners>> owners;  // Группы по id оценки (NO_STUDENT - нет такой)
+
+    // Оценки студента; nullptr, если их нет
+    const StudentGrades* find(int student_id) const;
+    // Студент, которому принадлежит оценка; false, если оценки нет
+    bool ownerOf(int grade_id, int& student_id) const;
+
+    // Обход по student_id, затем semester, subject; visit возвращает false, чтобы прервать обход
+    template<typename Visit>
+    void forEach(const Visit& visit) const {
+        for (const auto& shard : shards) {
+            if (!shard) {
+                continue;
+            }
+            for (const auto& entry : *shard) {
+                for (const Grade& grade : entry.second->grades) {
+                    if (!visit(grade)) {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+};
+
+// Кэш студентов и оценок в памяти процесса.
+// Читатели получают текущий снимок без блокировок (атомарная загрузка shared_ptr);
+// писатели под мьютексом копируют снимок (списки указателей на группы), заменяют
+// измененную группу и атомарно подменяют указатель.
+// Старый снимок живет, пока его держит хотя бы один читатель.
+class DataCache {
+public:
+    using StudentsLoader = std::function<std::vector<Student>()>;
+    using GradesLoader = std::function<std::vector<Grade>()>;
+
+private:
+    std::shared_ptr<const StudentsSnapshot> students;
+    std::shared_ptr<const GradesSnapshot> grades;
+
+    std::mutex write_mutex;             // Сериализует загрузку и изменения снимков
+    std::atomic<uint64_t> version{0};   // Растет при каждом изменении данных
+    const uint64_t epoch;               // Случайная метка процесса: после перезапуска version начинается заново
+
+    void storeStudents(std::shared_ptr<StudentsSnapshot> snapshot);
+    void storeGrades(std::shared_ptr<GradesSnapshot> snapshot);
+
+public:
+    DataCache();
+
+    // Текущий снимок; при пустом кэше загружает данные через loader.
+    // Исключения loader пробрасываются, пустой кэш при этом не заполняется
+    std::shared_ptr<const StudentsSnapshot> getStudents(const StudentsLoader& loader);
+    std::shared_ptr<const GradesSnapshot> getGrades(const GradesLoader& loader);
+
+    // Точечные изменения после успешной записи в БД
+    void upsertStudent(const Student& student);
+    void removeStudent(int id);         // Удаляет и оценки студента (ON DELETE CASCADE)
+    void upsertGrade(const Grade& grade);
+    void removeGrade(int id);
+
+    // Сбросить снимки: следующее чтение загрузит их из БД заново
+    void invalidate();
+
+    // Сменить версию, не трогая снимки (ответ, собранный без данных, не должен совпасть по версии)
+    void markChanged() { version++; }
+
+    // Снимок вне кэша (version = 0) - для работы с отключенным кэшем
+    static std::shared_ptr<const StudentsSnapshot> makeStudentsSnapshot(std::vector<Student> list);
+    static std::shared_ptr<const GradesSnapshot> makeGradesSnapshot(std::vector<Grade> list);
+
+    uint64_t getVersion() const { return version.load(); }
+    uint64_t getEpoch() const { return epoch; }
+};
+
+#endif
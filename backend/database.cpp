@@ -1,252 +1,251 @@
 #include "database.h"
 #include "queries.h"
 #include "password_hash.h"
-#include <iostream>
+#include "hashing_pool.h"
+#include "metrics.h"
+#include "log.h"
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
 #include <cmath>
 #include <string>
+#include <utility>
+#include <tuple>
+#include <unordered_set>
+#include <random>
+#include <stdexcept>
 
-Database::Database(const std::string& conn_str) : connection_string(conn_str) {}
+namespace {
+    // Выполнить подготовленный запрос из Queries (время выполнения - в метрики)
+    template<typename... Args>
+    pqxx::result execQuery(pqxx::transaction_base& txn, Queries::Id id, Args&&... args) {
+        uint64_t start = Metrics::now();
+        try {
+            pqxx::result result = txn.exec_prepared(Queries::name(id), std::forward<Args>(args)...);
+            Metrics::recordQuery(static_cast<size_t>(id), Metrics::now() - start, false);
+            return result;
+        } catch (...) {
+            Metrics::recordQuery(static_cast<size_t>(id), Metrics::now() - start, true);
+            throw;
+        }
+    }
+    
+    // Строка (id, name, surname, group_name)
+    Student studentFromRow(const pqxx::row& row) {
+        Student student;
+        student.id = row[0].as<int>();
+        student.name = row[1].as<std::string>();
+        student.surname = row[2].as<std::string>();
+        student.group_name = row[3].as<std::string>();
+        return student;
+    }
+    
+    // Строка (id, student_id, subject, grade, semester, attendance_percent, assignment_completion, exam_result)
+    Grade gradeFromRow(const pqxx::row& row) {
+        Grade grade;
+        grade.id = row[0].as<int>();
+        grade.student_id = row[1].is_null() ? 0 : row[1].as<int>();
+        grade.subject = row[2].as<std::string>();
+        grade.grade = row[3].is_null() ? 0 : row[3].as<int>();
+        grade.semester = row[4].as<int>();
+        grade.attendance_percent = row[5].is_null() ? 0.0 : row[5].as<double>();
+        grade.assignment_completion = row[6].is_null() ? 0.0 : row[6].as<double>();
+        grade.exam_result = row[7].is_null() ? 0 : row[7].as<int>();
+        return grade;
+    }
+}
+
+namespace {
+    // Сколько строк курсор читает из БД за один раз
+    const long CURSOR_BATCH_ROWS = 1000;
+
+    // Случайная метка процесса (16 hex-символов)
+    std::string makeInstanceId() {
+        std::random_device random;
+        std::ostringstream id;
+        id << std::hex << std::setfill('0') << std::setw(8) << random() << std::setw(8) << random();
+        return id.str();
+    }
+}
 
-Database::~Database() {}
+Database::Database(const std::string& conn_str, const PoolConfig& pool_config, bool cache_enabled)
+    : connection_string(conn_str), instance_id(makeInstanceId()),
+      pool(conn_str, pool_config, [this](pqxx::connection& conn) { setupConnection(conn); }),
+      cache_enabled(cache_enabled) {}
 
-bool Database::registerUserWithRole(const std::string& username, const std::string& password, const std::string& email, const std::string& role) {
+Database::~Database() {
+    // Фоновые потоки обращаются к кэшу и пулу - останавливаем их первыми.
+    // Очередь записей перед остановкой выполняется до конца
+    batcher.reset();
+    listener.reset();
+}
+
+void Database::setupConnection(pqxx::connection& conn) {
+    for (size_t i = 0; i < Queries::COUNT; i++) {
+        auto id = static_cast<Queries::Id>(i);
+        conn.prepare(Queries::name(id), Queries::sql(id));
+    }
+    // На все время сессии: триггер notify_data_change добавляет его в уведомления
+    pqxx::nontransaction txn(conn);
+    txn.exec("SET app.instance = '" + instance_id + "'");
+}
+
+PoolStats Database::getPoolStats() const {
+    return pool.stats();
+}
+
+RegisterResult Database::insertUser(pqxx::transaction_base& txn, const std::string& username,
+                                   const std::string& password_hash, const std::string& email, const std::string& role) {
+    // Один запрос: вставка с ON CONFLICT DO NOTHING и, если строка не вставлена,
+    // какое из уникальных полей занято
+    pqxx::result result = execQuery(txn, Queries::Id::INSERT_USER, username, password_hash, email, role);
+    if (!result[0][0].is_null()) {
+        return RegisterResult::Created;
+    }
+    std::string conflict = result[0][1].is_null() ? "" : result[0][1].as<std::string>();
+    if (conflict.empty()) {
+        // Конфликт с регистрацией, закоммиченной уже после начала запроса: ее строку снимок
+        // запроса не видит. Отдельный запрос получает новый снимок - лишний обмен только в этой гонке
+        pqxx::result taken = execQuery(txn, Queries::Id::FIND_USER_CONFLICT, username, email);
+        conflict = taken[0][0].is_null() ? "" : taken[0][0].as<std::string>();
+    }
+    if (conflict == "username") {
+        return RegisterResult::UsernameTaken;
+    }
+    if (conflict == "email") {
+        return RegisterResult::EmailTaken;
+    }
+    // Конфликтующая строка успела исчезнуть
+    return RegisterResult::Taken;
+}
+
+RegisterResult Database::registerUserWithRole(const std::string& username, const std::string& password,
+                                              const std::string& email, const std::string& role) {
     try {
-        pqxx::connection conn(connection_string);
-        pqxx::work txn(conn);
-        
-        // Проверка на существование пользователя по username
-        pqxx::result check_username = txn.exec_params(Queries::CHECK_USER_EXISTS, username);
-        if (!check_username.empty()) {
-            std::cerr << "Registration with role failed: username already exists: " << username << std::endl;
-            return false;
-        }
-        
-        // Проверка на существование пользователя по email
-        pqxx::result check_email = txn.exec_params(Queries::CHECK_EMAIL_EXISTS, email);
-        if (!check_email.empty()) {
-            std::cerr << "Registration with role failed: email already exists: " << email << std::endl;
-            return false;
+        // Хешируем пароль, не занимая соединение с БД: хеш намеренно дорогой.
+        // Занятые имя или email (и параллельную регистрацию с теми же) отсечет ON CONFLICT
+        // при вставке - отдельной проверки до хеширования нет, регистрация - один обмен с сервером
+        std::string passwordHash;
+        if (!runHashing([&] { passwordHash = PasswordHash::hashPassword(password); })) {
+            LOG_WARN("Registration rejected: password hashing queue is full", {{"user", username}});
+            return RegisterResult::Overloaded;
         }
         
-        // Хешируем пароль перед сохранением
-        std::string passwordHash = PasswordHash::hashPassword(password);
+        // Один оператор вне транзакции - без BEGIN/COMMIT, один обмен с сервером
+        auto conn = pool.acquire();
+        pqxx::nontransaction txn(*conn);
+        RegisterResult result = insertUser(txn, username, passwordHash, email, role);
         
-        // Используем INSERT с обработкой возможного нарушения уникальности
-        // (на случай race condition между проверкой и вставкой)
-        try {
-            txn.exec_params(Queries::INSERT_USER_WITH_ROLE, username, passwordHash, email, role);
-            txn.commit();
-            std::cout << "User with role registered successfully: " << username << " (" << role << ")" << std::endl;
-            return true;
-        } catch (const pqxx::sql_error& e) {
-            // Проверяем, является ли это нарушением уникальности (SQLSTATE 23505)
-            std::string sqlstate = e.sqlstate();
-            if (sqlstate == "23505") {
-                // Если все же произошло нарушение уникальности (race condition),
-                // откатываем транзакцию и проверяем что именно нарушено
-                txn.abort();
-                std::cerr << "Database unique violation (race condition): " << e.what() << std::endl;
-                
-                // Проверяем еще раз, что именно нарушено
-                pqxx::work txn2(conn);
-                pqxx::result check_username2 = txn2.exec_params(Queries::CHECK_USER_EXISTS, username);
-                if (!check_username2.empty()) {
-                    std::cerr << "Username exists (race condition): " << username << std::endl;
-                    return false;
-                }
-                
-                pqxx::result check_email2 = txn2.exec_params(Queries::CHECK_EMAIL_EXISTS, email);
-                if (!check_email2.empty()) {
-                    std::cerr << "Email exists (race condition): " << email << std::endl;
-                    return false;
-                }
-                
-                // Если не понятно что, возвращаем false
-                return false;
-            } else {
-                // Другая SQL ошибка, пробрасываем дальше
-                throw;
-            }
+        switch (result) {
+            case RegisterResult::Created:
+                LOG_INFO("User registered", {{"user", username}, {"role", role}});
+                break;
+            case RegisterResult::UsernameTaken:
+                LOG_INFO("Registration failed: username already exists", {{"user", username}});
+                break;
+            case RegisterResult::EmailTaken:
+                LOG_INFO("Registration failed: email already exists", {{"email", email}});
+                break;
+            default:
+                LOG_INFO("Registration failed: concurrent registration with the same username or email",
+                         {{"user", username}});
+                break;
         }
+        return result;
     } catch (const pqxx::sql_error& e) {
-        // Проверяем, является ли это нарушением уникальности (SQLSTATE 23505)
-        std::string sqlstate = e.sqlstate();
-        if (sqlstate == "23505") {
-            std::cerr << "Database unique violation: " << e.what() << std::endl;
-            return false;
-        }
-        // Другая SQL ошибка
-        std::cerr << "Database SQL error in registerUserWithRole: " << e.what() << " (SQLSTATE: " << sqlstate << ")" << std::endl;
-        return false;
+        LOG_ERROR("Database SQL error in registerUserWithRole", {{"error", e.what()}, {"sqlstate", e.sqlstate()}});
+        return RegisterResult::Error;
     } catch (const std::exception& e) {
-        std::cerr << "Database error in registerUserWithRole: " << e.what() << std::endl;
-        return false;
+        LOG_ERROR("Database error in registerUserWithRole", {{"error", e.what()}});
+        return RegisterResult::Error;
     }
 }
 
 bool Database::createDefaultAdmin() {
     // Создать тестового админа, если его еще нет
     try {
-        std::cout << "Checking for default admin user..." << std::endl;
-        pqxx::connection conn(connection_string);
-        pqxx::work txn(conn);
+        LOG_DEBUG("Checking for default admin user");
+        auto conn = pool.acquire();
+        pqxx::work txn(*conn);
         
         // Проверка существования админа по username
-        pqxx::result check = txn.exec_params(Queries::CHECK_USER_EXISTS, std::string("admin"));
+        pqxx::result check = execQuery(txn, Queries::Id::CHECK_USER_EXISTS, std::string("admin"));
         if (!check.empty()) {
             // Админ уже существует, проверяем его роль
-            std::cout << "Admin user already exists, checking role..." << std::endl;
-            pqxx::result adminResult = txn.exec_params(Queries::GET_USER_BY_USERNAME, std::string("admin"));
+            LOG_DEBUG("Admin user already exists, checking role");
+            pqxx::result adminResult = execQuery(txn, Queries::Id::GET_USER_BY_USERNAME, std::string("admin"));
             if (!adminResult.empty()) {
                 std::string existingRole;
                 // Проверяем, не NULL ли роль
                 if (adminResult[0][3].is_null()) {
                     existingRole = "";
-                    std::cout << "Existing admin role is NULL" << std::endl;
                 } else {
                     existingRole = adminResult[0][3].as<std::string>();
-                    std::cout << "Existing admin role: '" << existingRole << "'" << std::endl;
                 }
                 
                 // Если роль не admin (NULL, пустая или другая), обновляем ее
                 if (existingRole.empty() || existingRole != "admin") {
-                    std::cout << "Updating admin role to 'admin'..." << std::endl;
-                    txn.exec("UPDATE users SET role = 'admin' WHERE username = 'admin'");
+                    execQuery(txn, Queries::Id::SET_USER_ROLE, std::string("admin"), std::string("admin"));
                     txn.commit();
-                    std::cout << "Admin role updated successfully" << std::endl;
+                    LOG_INFO("Admin role updated", {{"previous_role", existingRole}});
                 } else {
-                    std::cout << "Admin role is correct: " << existingRole << std::endl;
+                    LOG_DEBUG("Admin role is correct");
                 }
             }
             return true;
         }
         
         // Проверяем, может быть админ существует с другим email
-        pqxx::result emailCheck = txn.exec_params(Queries::CHECK_EMAIL_EXISTS, std::string("admin@example.com"));
+        pqxx::result emailCheck = execQuery(txn, Queries::Id::CHECK_EMAIL_EXISTS, std::string("admin@example.com"));
         if (!emailCheck.empty()) {
-            std::cout << "Warning: Email admin@example.com already exists with different username" << std::endl;
+            LOG_WARN("Email admin@example.com already exists with different username");
         }
         
         // Создаем админа с ролью admin
-        std::cout << "Creating default admin user..." << std::endl;
         std::string passwordHash = PasswordHash::hashPassword("admin");
-        std::cout << "Password hash generated, length: " << passwordHash.length() << std::endl;
         
-        txn.exec_params(Queries::INSERT_USER_WITH_ROLE, 
-                       std::string("admin"), 
-                       passwordHash, 
-                       std::string("admin@example.com"),
-                       std::string("admin"));
+        if (insertUser(txn, "admin", passwordHash, "admin@example.com", "admin") != RegisterResult::Created) {
+            LOG_WARN("Default admin not created: username or email already taken");
+            return false;
+        }
         txn.commit();
-        std::cout << "Тестовый админ создан: username=admin, password=admin, role=admin" << std::endl;
+        LOG_INFO("Default admin created", {{"user", "admin"}, {"password", "admin"}, {"role", "admin"}});
         return true;
     } catch (const std::exception& e) {
-        std::cerr << "Database error при создании админа: " << e.what() << std::endl;
+        LOG_ERROR("Database error in createDefaultAdmin", {{"error", e.what()}});
         return false;
     }
 }
 
-bool Database::registerUser(const std::string& username, const std::string& password, const std::string& email) {
-    try {
-        pqxx::connection conn(connection_string);
-        pqxx::work txn(conn);
-        
-        // Проверка на существование пользователя по username
-        pqxx::result check_username = txn.exec_params(Queries::CHECK_USER_EXISTS, username);
-        if (!check_username.empty()) {
-            std::cerr << "Registration failed: username already exists: " << username << std::endl;
-            return false;
-        }
-        
-        // Проверка на существование пользователя по email
-        pqxx::result check_email = txn.exec_params(Queries::CHECK_EMAIL_EXISTS, email);
-        if (!check_email.empty()) {
-            std::cerr << "Registration failed: email already exists: " << email << std::endl;
-            return false;
-        }
-        
-        // Хешируем пароль перед сохранением
-        std::string passwordHash = PasswordHash::hashPassword(password);
-        
-        // Используем INSERT с обработкой возможного нарушения уникальности
-        // (на случай race condition между проверкой и вставкой)
-        try {
-            txn.exec_params(Queries::INSERT_USER, username, passwordHash, email);
-            txn.commit();
-            std::cout << "User registered successfully: " << username << std::endl;
-            return true;
-        } catch (const pqxx::sql_error& e) {
-            // Проверяем, является ли это нарушением уникальности (SQLSTATE 23505)
-            std::string sqlstate = e.sqlstate();
-            if (sqlstate == "23505") {
-                // Если все же произошло нарушение уникальности (race condition),
-                // откатываем транзакцию и проверяем что именно нарушено
-                txn.abort();
-                std::cerr << "Database unique violation (race condition): " << e.what() << std::endl;
-                
-                // Проверяем еще раз, что именно нарушено
-                pqxx::work txn2(conn);
-                pqxx::result check_username2 = txn2.exec_params(Queries::CHECK_USER_EXISTS, username);
-                if (!check_username2.empty()) {
-                    std::cerr << "Username exists (race condition): " << username << std::endl;
-                    return false;
-                }
-                
-                pqxx::result check_email2 = txn2.exec_params(Queries::CHECK_EMAIL_EXISTS, email);
-                if (!check_email2.empty()) {
-                    std::cerr << "Email exists (race condition): " << email << std::endl;
-                    return false;
-                }
-                
-                // Если не понятно что, возвращаем false
-                return false;
-            } else {
-                // Другая SQL ошибка, пробрасываем дальше
-                throw;
-            }
-        }
-    } catch (const pqxx::sql_error& e) {
-        // Проверяем, является ли это нарушением уникальности (SQLSTATE 23505)
-        std::string sqlstate = e.sqlstate();
-        if (sqlstate == "23505") {
-            std::cerr << "Database unique violation: " << e.what() << std::endl;
-            return false;
-        }
-        // Другая SQL ошибка
-        std::cerr << "Database SQL error in registerUser: " << e.what() << " (SQLSTATE: " << sqlstate << ")" << std::endl;
-        return false;
-    } catch (const std::exception& e) {
-        std::cerr << "Database error in registerUser: " << e.what() << std::endl;
-        return false;
-    }
+RegisterResult Database::registerUser(const std::string& username, const std::string& password, const std::string& email) {
+    return registerUserWithRole(username, password, email, "user");
 }
 
-User* Database::authenticateUser(const std::string& username, const std::string& password) {
+std::optional<User> Database::authenticateUser(const std::string& username, const std::string& password,
+                                               bool& overloaded) {
+    overloaded = false;
     try {
-        std::cout << "Attempting authentication for username: " << username << std::endl;
-        pqxx::connection conn(connection_string);
-        pqxx::work txn(conn);
-        
-        // Получаем пользователя по имени (включая хеш пароля)
-        pqxx::result result = txn.exec_params(Queries::GET_USER_BY_USERNAME, username);
+        // Получаем пользователя по имени (включая хеш пароля). Соединение возвращается
+        // в пул до проверки пароля, чтобы не держать его, пока считается хеш
+        pqxx::result result;
+        {
+            auto conn = pool.acquire();
+            pqxx::work txn(*conn);
+            result = execQuery(txn, Queries::Id::GET_USER_BY_USERNAME, username);
+        }
         
         if (result.empty()) {
-            std::cerr << "Authentication failed: user not found: " << username << std::endl;
-            return nullptr;
+            LOG_INFO("Authentication failed: user not found", {{"user", username}});
+            return std::nullopt;
         }
         
-        std::cout << "User found in database: " << username << std::endl;
-        
         // Получаем сохраненный хеш пароля (колонка 4 - password)
         std::string storedPasswordHash = result[0][4].as<std::string>();
         
         // Получаем роль, проверяя на NULL
         std::string userRole;
         if (result[0][3].is_null()) {
-            std::cerr << "Warning: User role is NULL, setting to 'user' by default" << std::endl;
+            LOG_WARN("User role is NULL, setting to 'user' by default", {{"user", username}});
             userRole = "user";
         } else {
             userRole = result[0][3].as<std::string>();
@@ -254,258 +253,788 @@ User* Database::authenticateUser(const std::string& username, const std::string&
         
         // Если роль пустая, устанавливаем по умолчанию 'user'
         if (userRole.empty()) {
-            std::cerr << "Warning: User role is empty, setting to 'user' by default" << std::endl;
+            LOG_WARN("User role is empty, setting to 'user' by default", {{"user", username}});
             userRole = "user";
         }
         
-        std::cout << "User role from DB: " << (userRole.empty() ? "(empty)" : userRole) << std::endl;
-        std::cout << "Stored password hash length: " << storedPasswordHash.length() << std::endl;
-        
-        // Проверяем пароль
-        bool passwordValid = PasswordHash::verifyPassword(password, storedPasswordHash);
-        std::cout << "Password verification result: " << (passwordValid ? "SUCCESS" : "FAILED") << std::endl;
-        
+        // Проверяем пароль; хеш в старом формате или со слабыми параметрами
+        // пересчитываем сразу, пока известен пароль
+        bool passwordValid = false;
+        std::string upgradedHash;
+        if (!runHashing([&] {
+                passwordValid = PasswordHash::verifyPassword(password, storedPasswordHash);
+                if (passwordValid && PasswordHash::needsRehash(storedPasswordHash)) {
+                    try {
+                        upgradedHash = PasswordHash::hashPassword(password);
+                    } catch (const std::exception& e) {
+                        // Вход не зависит от обновления хеша - попробуем при следующем входе
+                        LOG_WARN("Password rehash failed", {{"user", username}, {"error", e.what()}});
+                    }
+                }
+            })) {
+            LOG_WARN("Authentication rejected: password hashing queue is full", {{"user", username}});
+            overloaded = true;
+            return std::nullopt;
+        }
         if (!passwordValid) {
-            std::cerr << "Authentication failed: invalid password for user: " << username << std::endl;
-            return nullptr;
+            LOG_INFO("Authentication failed: invalid password", {{"user", username}});
+            return std::nullopt;
         }
         
         // Пароль верный, создаем объект пользователя
-        User* user = new User();
-        user->id = result[0][0].as<int>();
-        user->username = result[0][1].as<std::string>();
-        user->email = result[0][2].as<std::string>();
-        user->role = result[0][3].as<std::string>();
+        User user;
+        user.id = result[0][0].as<int>();
+        user.username = result[0][1].as<std::string>();
+        user.email = result[0][2].as<std::string>();
+        user.role = userRole;
         
-        std::cout << "Authentication successful for user: " << username << " (role: " << user->role << ")" << std::endl;
+        if (!upgradedHash.empty()) {
+            upgradePasswordHash(user.id, storedPasswordHash, upgradedHash);
+        }
+        
+        LOG_DEBUG("Authentication successful", {{"user", username}, {"role", user.role}});
         return user;
     } catch (const std::exception& e) {
-        std::cerr << "Database error in authenticateUser: " << e.what() << std::endl;
-        return nullptr;
+        LOG_ERROR("Database error in authenticateUser", {{"error", e.what()}});
+        return std::nullopt;
     }
 }
 
-bool Database::isAdmin(int user_id) {
+void Database::upgradePasswordHash(int user_id, const std::string& old_hash, const std::string& new_hash) {
     try {
-        pqxx::connection conn(connection_string);
-        pqxx::work txn(conn);
-        
-        pqxx::result result = txn.exec_params(Queries::GET_USER_ROLE, user_id);
-        
-        if (!result.empty() && result[0][0].as<std::string>() == "admin") {
-            return true;
+        auto conn = pool.acquire();
+        pqxx::work txn(*conn);
+        // Только если пароль не сменили, пока считался новый хеш
+        pqxx::result result = execQuery(txn, Queries::Id::UPDATE_USER_PASSWORD, new_hash, user_id, old_hash);
+        txn.commit();
+        if (result.affected_rows() > 0) {
+            LOG_DEBUG("Password hash upgraded", {{"user_id", user_id}});
         }
-        return false;
     } catch (const std::exception& e) {
-        std::cerr << "Database error: " << e.what() << std::endl;
-        return false;
+        // Вход это не отменяет: хеш пересчитается при следующем входе
+        LOG_ERROR("Database error in upgradePasswordHash", {{"error", e.what()}});
     }
 }
 
-std::vector<Student> Database::getAllStudents() {
+void Database::enableHashingPool(const HashingPoolConfig& config) {
+    if (hasher) {
+        return;
+    }
+    hasher = std::make_unique<HashingPool>(config);
+    LOG_INFO("Password hashing pool", {{"workers", config.workers}, {"queue", config.max_queued}});
+}
+
+HashingPoolStats Database::getHashingStats() const {
+    return hasher ? hasher->stats() : HashingPoolStats();
+}
+
+bool Database::runHashing(const std::function<void()>& job) {
+    if (!hasher) {
+        job();
+        return true;
+    }
+    return hasher->run(job);
+}
+
+std::vector<Student> Database::loadAllStudents() {
+    auto conn = pool.acquire();
+    pqxx::work txn(*conn);
+    
+    pqxx::result result = execQuery(txn, Queries::Id::GET_ALL_STUDENTS);
+    
     std::vector<Student> students;
+    students.reserve(result.size());
+    for (auto row : result) {
+        students.push_back(studentFromRow(row));
+    }
+    return students;
+}
+
+std::vector<Grade> Database::loadAllGrades() {
+    auto conn = pool.acquire();
+    pqxx::work txn(*conn);
+    
+    pqxx::result result = execQuery(txn, Queries::Id::GET_ALL_GRADES);
+    
+    std::vector<Grade> grades;
+    grades.reserve(result.size());
+    for (auto row : result) {
+        grades.push_back(gradeFromRow(row));
+    }
+    return grades;
+}
+
+std::vector<Grade> Database::loadStudentGrades(int student_id) {
+    auto conn = pool.acquire();
+    pqxx::work txn(*conn);
+    
+    pqxx::result result = execQuery(txn, Queries::Id::GET_STUDENT_GRADES, student_id);
+    
+    std::vector<Grade> grades;
+    grades.reserve(result.size());
+    for (auto row : result) {
+        grades.push_back(gradeFromRow(row));
+    }
+    return grades;
+}
+
+std::vector<Grade> Database::loadGradesForStudents(const std::vector<int>& student_ids) {
+    auto conn = pool.acquire();
+    pqxx::work txn(*conn);
+    
+    // Массив одним параметром: '{1,2,3}'
+    std::string ids = "{";
+    for (size_t i = 0; i < student_ids.size(); i++) {
+        if (i > 0) {
+            ids += ',';
+        }
+        ids += std::to_string(student_ids[i]);
+    }
+    ids += '}';
+    pqxx::result result = execQuery(txn, Queries::Id::GET_GRADES_FOR_STUDENTS, ids);
+    
+    std::vector<Grade> grades;
+    grades.reserve(result.size());
+    for (auto row : result) {
+        grades.push_back(gradeFromRow(row));
+    }
+    return grades;
+}
+
+std::shared_ptr<const StudentsSnapshot> Database::getStudentsSnapshot() {
     try {
-        pqxx::connection conn(connection_string);
-        pqxx::work txn(conn);
-        
-        pqxx::result result = txn.exec(Queries::GET_ALL_STUDENTS);
-        
-        for (auto row : result) {
-            Student student;
-            student.id = row[0].as<int>();
-            student.name = row[1].as<std::string>();
-            student.surname = row[2].as<std::string>();
-            student.group_name = row[3].as<std::string>();
-            students.push_back(student);
+        if (!cache_enabled) {
+            return DataCache::makeStudentsSnapshot(loadAllStudents());
         }
+        return cache.getStudents([this] { return loadAllStudents(); });
     } catch (const std::exception& e) {
-        std::cerr << "Database error: " << e.what() << std::endl;
+        LOG_ERROR("Database error in getStudentsSnapshot", {{"error", e.what()}});
+        // Пустой снимок не должен получить ETag текущей версии данных
+        if (cache_enabled) {
+            cache.markChanged();
+        }
+        return std::make_shared<const StudentsSnapshot>();
     }
-    return students;
 }
 
-bool Database::addStudent(const std::string& name, const std::string& surname, const std::string& group_name) {
+std::shared_ptr<const GradesSnapshot> Database::getGradesSnapshot() {
     try {
-        pqxx::connection conn(connection_string);
-        pqxx::work txn(conn);
-        
-        txn.exec_params(Queries::INSERT_STUDENT, name, surname, group_name);
-        txn.commit();
-        return true;
+        if (!cache_enabled) {
+            return DataCache::makeGradesSnapshot(loadAllGrades());
+        }
+        return cache.getGrades([this] { return loadAllGrades(); });
     } catch (const std::exception& e) {
-        std::cerr << "Database error: " << e.what() << std::endl;
-        return false;
+        LOG_ERROR("Database error in getGradesSnapshot", {{"error", e.what()}});
+        if (cache_enabled) {
+            cache.markChanged();
+        }
+        return std::make_shared<const GradesSnapshot>();
     }
 }
 
-bool Database::updateStudent(int id, const std::string& name, const std::string& surname, const std::string& group_name) {
+uint64_t Database::getDataVersion() const {
+    return cache.getVersion();
+}
+
+std::string Database::getDataTag() {
+    std::ostringstream tag;
+    if (cache_enabled) {
+        tag << std::hex << cache.getEpoch() << "-" << cache.getVersion();
+        return tag.str();
+    }
+    
+    // Без кэша - общий счетчик из БД: одинаковый во всех экземплярах
+    try {
+        auto conn = pool.acquire();
+        pqxx::nontransaction txn(*conn);
+        pqxx::result result = execQuery(txn, Queries::Id::GET_DATA_VERSION);
+        if (result.empty()) {
+            return "";
+        }
+        tag << "db-" << std::hex << result[0][0].as<int64_t>();
+        return tag.str();
+    } catch (const std::exception& e) {
+        LOG_ERROR("Database error in getDataTag", {{"error", e.what()}});
+        return "";
+    }
+}
+
+bool Database::forEachStudent(const std::function<bool(const Student&)>& visit) {
+    if (cache_enabled) {
+        getStudentsSnapshot()->forEach(visit);
+        return true;
+    }
+    
     try {
-        pqxx::connection conn(connection_string);
-        pqxx::work txn(conn);
+        auto conn = pool.acquire();
+        pqxx::work txn(*conn);
+        pqxx::icursorstream cursor(txn, Queries::sql(Queries::Id::GET_ALL_STUDENTS), "students_cursor", CURSOR_BATCH_ROWS);
         
-        txn.exec_params(Queries::UPDATE_STUDENT, name, surname, group_name, id);
-        txn.commit();
+        pqxx::result batch;
+        while (cursor >> batch) {
+            for (auto row : batch) {
+                if (!visit(studentFromRow(row))) {
+                    return true;
+                }
+            }
+        }
         return true;
     } catch (const std::exception& e) {
-        std::cerr << "Database error: " << e.what() << std::endl;
+        LOG_ERROR("Database error in forEachStudent", {{"error", e.what()}});
         return false;
     }
 }
 
-bool Database::deleteStudent(int id) {
+bool Database::forEachGrade(const std::function<bool(const Grade&)>& visit) {
+    if (cache_enabled) {
+        getGradesSnapshot()->forEach(visit);
+        return true;
+    }
+    
     try {
-        pqxx::connection conn(connection_string);
-        pqxx::work txn(conn);
+        auto conn = pool.acquire();
+        pqxx::work txn(*conn);
+        pqxx::icursorstream cursor(txn, Queries::sql(Queries::Id::GET_ALL_GRADES), "grades_cursor", CURSOR_BATCH_ROWS);
         
-        txn.exec_params(Queries::DELETE_STUDENT, id);
-        txn.commit();
+        pqxx::result batch;
+        while (cursor >> batch) {
+            for (auto row : batch) {
+                if (!visit(gradeFromRow(row))) {
+                    return true;
+                }
+            }
+        }
         return true;
     } catch (const std::exception& e) {
-        std::cerr << "Database error: " << e.what() << std::endl;
+        LOG_ERROR("Database error in forEachGrade", {{"error", e.what()}});
         return false;
     }
 }
 
-std::vector<Grade> Database::getStudentGrades(int student_id) {
-    std::vector<Grade> grades;
+bool Database::getStudentsPage(const StudentPageQuery& query, std::vector<Student>& page, bool& has_more) {
+    page.clear();
+    has_more = false;
     try {
-        pqxx::connection conn(connection_string);
-        pqxx::work txn(conn);
+        auto conn = pool.acquire();
+        pqxx::work txn(*conn);
         
-        pqxx::result result = txn.exec_params(Queries::GET_STUDENT_GRADES, student_id);
+        // Лишняя строка показывает, есть ли следующая страница
+        long fetch = query.limit + 1;
+        pqxx::result result = query.group_name.empty()
+            ? execQuery(txn, Queries::Id::GET_STUDENTS_PAGE, query.after_id, fetch)
+            : execQuery(txn, Queries::Id::GET_STUDENTS_PAGE_BY_GROUP, query.group_name, query.after_id, fetch);
         
+        has_more = (long)result.size() > query.limit;
+        page.reserve(std::min<size_t>(result.size(), query.limit));
         for (auto row : result) {
-            Grade grade;
-            grade.id = row[0].as<int>();
-            grade.student_id = row[1].as<int>();
-            grade.subject = row[2].as<std::string>();
-            grade.grade = row[3].as<int>();
-            grade.semester = row[4].as<int>();
-            grade.attendance_percent = row[5].as<double>();
-            grade.assignment_completion = row[6].as<double>();
-            grade.exam_result = row[7].is_null() ? 0 : row[7].as<int>();
-            grades.push_back(grade);
+            if ((long)page.size() == query.limit) {
+                break;
+            }
+            page.push_back(studentFromRow(row));
         }
+        return true;
     } catch (const std::exception& e) {
-        std::cerr << "Database error: " << e.what() << std::endl;
+        LOG_ERROR("Database error in getStudentsPage", {{"error", e.what()}});
+        page.clear();
+        return false;
     }
-    return grades;
 }
 
-std::vector<Grade> Database::getAllGrades() {
-    std::vector<Grade> grades;
+bool Database::getGradesPage(const GradePageQuery& query, std::vector<Grade>& page, bool& has_more) {
+    page.clear();
+    has_more = false;
     try {
-        pqxx::connection conn(connection_string);
-        pqxx::work txn(conn);
+        auto conn = pool.acquire();
+        pqxx::work txn(*conn);
         
-        pqxx::result result = txn.exec(Queries::GET_ALL_GRADES);
+        // Ведущий фильтр выбирает индекс: student_id, затем subject, затем semester
+        long fetch = query.limit + 1;
+        pqxx::result result;
+        if (query.student_id != 0) {
+            result = execQuery(txn, Queries::Id::GET_GRADES_PAGE_BY_STUDENT, query.student_id, query.after_id,
+                               query.subject, query.semester, fetch);
+        } else if (!query.subject.empty()) {
+            result = execQuery(txn, Queries::Id::GET_GRADES_PAGE_BY_SUBJECT, query.subject, query.after_id,
+                               query.semester, fetch);
+        } else if (query.semester != 0) {
+            result = execQuery(txn, Queries::Id::GET_GRADES_PAGE_BY_SEMESTER, query.semester, query.after_id, fetch);
+        } else {
+            result = execQuery(txn, Queries::Id::GET_GRADES_PAGE, query.after_id, fetch);
+        }
         
+        has_more = (long)result.size() > query.limit;
+        page.reserve(std::min<size_t>(result.size(), query.limit));
         for (auto row : result) {
-            Grade grade;
-            grade.id = row[0].as<int>();
-            grade.student_id = row[1].as<int>();
-            grade.subject = row[2].as<std::string>();
-            grade.grade = row[3].as<int>();
-            grade.semester = row[4].as<int>();
-            grade.attendance_percent = row[5].as<double>();
-            grade.assignment_completion = row[6].as<double>();
-            grade.exam_result = row[7].is_null() ? 0 : row[7].as<int>();
-            grades.push_back(grade);
+            if ((long)page.size() == query.limit) {
+                break;
+            }
+            page.push_back(gradeFromRow(row));
         }
+        return true;
     } catch (const std::exception& e) {
-        std::cerr << "Database error: " << e.what() << std::endl;
+        LOG_ERROR("Database error in getGradesPage", {{"error", e.what()}});
+        page.clear();
+        return false;
     }
-    return grades;
 }
 
-bool Database::addGrade(int student_id, const std::string& subject, int grade, int semester,
-                        double attendance, double assignment, int exam_result) {
-    try {
-        pqxx::connection conn(connection_string);
-        pqxx::work txn(conn);
-        
-        txn.exec_params(Queries::INSERT_GRADE, student_id, subject, grade, semester, attendance, assignment, exam_result);
-        txn.commit();
+void Database::startChangeListener() {
+    if (listener) {
+        return;
+    }
+    listener = std::make_unique<ChangeListener>(
+        connection_string, "data_changes",
+        [this](const DataChange& change) { applyChange(change); },
+        [this] { resyncCache(); });
+    listener->start();
+}
+
+namespace {
+    std::string ownChangeKey(const std::string& table, int id, int64_t txid) {
+        return table + ":" + std::to_string(id) + ":" + std::to_string(txid);
+    }
+}
+
+void Database::resyncCache() {
+    {
+        std::lock_guard<std::mutex> lock(own_changes_mutex);
+        own_pending.clear();
+        own_notified.clear();
+    }
+    cache.invalidate();
+}
+
+void Database::patchOwnChange(const std::string& table, int id, int64_t txid, const std::function<void()>& patch) {
+    if (!listener) {
+        patch();
+        return;
+    }
+    std::lock_guard<std::mutex> lock(own_changes_mutex);
+    std::string key = ownChangeKey(table, id, txid);
+    auto it = own_notified.find(key);
+    if (it != own_notified.end()) {
+        // Строка уже перечитана после коммита этой транзакции и, возможно, следующих -
+        // поправка старее того, что в кэше
+        if (--it->second == 0) {
+            own_notified.erase(it);
+        }
+        return;
+    }
+    own_pending[key]++;
+    patch();
+}
+
+void Database::applyChange(const DataChange& change) {
+    // Свой импорт уже сбросил кэш после коммита
+    if (change.origin == instance_id && (change.operation == "TRUNCATE" || change.operation == "RELOAD")) {
+        return;
+    }
+    if (change.operation == "TRUNCATE" || change.operation == "RELOAD") {
+        cache.invalidate();
+        return;
+    }
+    if (change.table != "students" && change.table != "student_grades") {
+        cache.invalidate();
+        return;
+    }
+    
+    // Перечитываем строку: в уведомлении только id, а к моменту обработки строку могли
+    // уже изменить или удалить. Уведомления приходят в порядке коммитов, поэтому последнее
+    // из них оставляет в кэше актуальную строку. Исключение при ошибке БД - listener
+    // тогда перечитает кэш целиком
+    bool students = change.table == "students";
+    std::optional<Student> student;
+    std::optional<Grade> grade;
+    if (change.operation != "DELETE") {
+        auto conn = pool.acquire();
+        pqxx::work txn(*conn);
+        pqxx::result result = execQuery(txn, students ? Queries::Id::GET_STUDENT_BY_ID : Queries::Id::GET_GRADE_BY_ID,
+                                        change.id);
+        if (!result.empty()) {
+            if (students) {
+                student = studentFromRow(result[0]);
+            } else {
+                grade = gradeFromRow(result[0]);
+            }
+        }
+    }
+    auto apply = [&] {
+        if (student) {
+            cache.upsertStudent(*student);
+        } else if (grade) {
+            cache.upsertGrade(*grade);
+        } else if (students) {
+            cache.removeStudent(change.id);
+        } else {
+            cache.removeGrade(change.id);
+        }
+    };
+    
+    // Чужое изменение, удаление (поправки удалений не бывают устаревшими) или
+    // уведомление без транзакции (init.sql старой версии)
+    if (change.origin != instance_id || change.operation == "DELETE" || change.txid == 0) {
+        apply();
+        return;
+    }
+    
+    // Свое изменение: поправка после коммита могла еще не дойти до кэша. Отмечаем
+    // уведомление обработанным, чтобы опоздавшая поправка не затерла перечитанную строку
+    std::lock_guard<std::mutex> lock(own_changes_mutex);
+    apply();
+    std::string key = ownChangeKey(change.table, change.id, change.txid);
+    auto it = own_pending.find(key);
+    if (it != own_pending.end()) {
+        if (--it->second == 0) {
+            own_pending.erase(it);
+        }
+    } else {
+        own_notified[key]++;
+    }
+}
+
+std::vector<Student> Database::getAllStudents() {
+    auto snapshot = getStudentsSnapshot();
+    std::vector<Student> students;
+    students.reserve(snapshot->count);
+    snapshot->forEach([&](const Student& student) {
+        students.push_back(student);
         return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Database error: " << e.what() << std::endl;
-        return false;
+    });
+    return students;
+}
+
+void Database::enableWriteBatching(const WriteBatchConfig& config) {
+    if (batcher) {
+        return;
     }
+    batcher = std::make_unique<WriteBatcher>(pool, config);
+    batcher->start();
+    LOG_INFO("Write batching", {{"window_us", (int64_t)config.window.count()}, {"max_ops", config.max_ops}});
 }
 
-bool Database::updateGrade(int id, const std::string& subject, int grade, int semester,
-                           double attendance, double assignment, int exam_result) {
+WriteBatchStats Database::getWriteBatchStats() const {
+    return batcher ? batcher->stats() : WriteBatchStats();
+}
+
+bool Database::runWrite(const WriteBatcher::Operation& op) {
+    if (batcher) {
+        return batcher->submit(op).get();
+    }
+    
     try {
-        pqxx::connection conn(connection_string);
-        pqxx::work txn(conn);
+        auto conn = pool.acquire();
+        pqxx::work txn(*conn);
         
-        txn.exec_params(Queries::UPDATE_GRADE, subject, grade, semester, attendance, assignment, exam_result, id);
+        WriteBatcher::AfterCommit after = op(txn);
         txn.commit();
+        
+        if (after) {
+            after();
+        }
         return true;
     } catch (const std::exception& e) {
-        std::cerr << "Database error: " << e.what() << std::endl;
+        LOG_ERROR("Database error in write", {{"error", e.what()}});
         return false;
     }
 }
 
+bool Database::addStudent(const std::string& name, const std::string& surname, const std::string& group_name) {
+    return runWrite([this, name, surname, group_name](pqxx::transaction_base& txn) -> WriteBatcher::AfterCommit {
+        pqxx::result result = execQuery(txn, Queries::Id::INSERT_STUDENT, name, surname, group_name);
+        if (result.empty()) {
+            return nullptr;
+        }
+        Student student = studentFromRow(result[0]);
+        int64_t txid = result[0][4].as<int64_t>();
+        return [this, student, txid] {
+            patchOwnChange("students", student.id, txid, [&] { cache.upsertStudent(student); });
+        };
+    });
+}
+
+bool Database::updateStudent(int id, const std::string& name, const std::string& surname, const std::string& group_name) {
+    return runWrite([this, id, name, surname, group_name](pqxx::transaction_base& txn) -> WriteBatcher::AfterCommit {
+        pqxx::result result = execQuery(txn, Queries::Id::UPDATE_STUDENT, name, surname, group_name, id);
+        if (result.empty()) {
+            return nullptr;
+        }
+        Student student = studentFromRow(result[0]);
+        int64_t txid = result[0][4].as<int64_t>();
+        return [this, student, txid] {
+            patchOwnChange("students", student.id, txid, [&] { cache.upsertStudent(student); });
+        };
+    });
+}
+
+bool Database::deleteStudent(int id) {
+    return runWrite([this, id](pqxx::transaction_base& txn) -> WriteBatcher::AfterCommit {
+        execQuery(txn, Queries::Id::DELETE_STUDENT, id);
+        return [this, id] { cache.removeStudent(id); };
+    });
+}
+
+std::vector<Grade> Database::getStudentGrades(int student_id) {
+    if (!cache_enabled) {
+        try {
+            return loadStudentGrades(student_id);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Database error in getStudentGrades", {{"error", e.what()}});
+            return {};
+        }
+    }
+    
+    // Оценки студента в снимке хранятся вместе и уже упорядочены по semester, subject
+    auto snapshot = getGradesSnapshot();
+    const StudentGrades* student = snapshot->find(student_id);
+    return student ? student->grades : std::vector<Grade>();
+}
+
+std::vector<Grade> Database::getAllGrades() {
+    auto snapshot = getGradesSnapshot();
+    std::vector<Grade> grades;
+    grades.reserve(snapshot->count);
+    snapshot->forEach([&](const Grade& grade) {
+        grades.push_back(grade);
+        return true;
+    });
+    return grades;
+}
+
+bool Database::addGrade(int student_id, const std::string& subject, int grade, int semester,
+                        double attendance, double assignment, int exam_result) {
+    return runWrite([=](pqxx::transaction_base& txn) -> WriteBatcher::AfterCommit {
+        pqxx::result result = execQuery(txn, Queries::Id::INSERT_GRADE, student_id, subject, grade, semester, attendance, assignment, exam_result);
+        if (result.empty()) {
+            return nullptr;
+        }
+        Grade inserted = gradeFromRow(result[0]);
+        int64_t txid = result[0][8].as<int64_t>();
+        return [this, inserted, txid] {
+            patchOwnChange("student_grades", inserted.id, txid, [&] { cache.upsertGrade(inserted); });
+        };
+    });
+}
+
+bool Database::updateGrade(int id, const std::string& subject, int grade, int semester,
+                           double attendance, double assignment, int exam_result) {
+    return runWrite([=](pqxx::transaction_base& txn) -> WriteBatcher::AfterCommit {
+        pqxx::result result = execQuery(txn, Queries::Id::UPDATE_GRADE, subject, grade, semester, attendance, assignment, exam_result, id);
+        if (result.empty()) {
+            return nullptr;
+        }
+        Grade updated = gradeFromRow(result[0]);
+        int64_t txid = result[0][8].as<int64_t>();
+        return [this, updated, txid] {
+            patchOwnChange("student_grades", updated.id, txid, [&] { cache.upsertGrade(updated); });
+        };
+    });
+}
+
 bool Database::deleteGrade(int id) {
+    return runWrite([this, id](pqxx::transaction_base& txn) -> WriteBatcher::AfterCommit {
+        execQuery(txn, Queries::Id::DELETE_GRADE, id);
+        return [this, id] { cache.removeGrade(id); };
+    });
+}
+
+bool Database::exportGrades(const std::function<bool(const Grade&, GradeExport::Nulls::Mask)>& visit) {
     try {
-        pqxx::connection conn(connection_string);
-        pqxx::work txn(conn);
+        auto conn = pool.acquire();
+        pqxx::read_transaction txn(*conn);
         
-        txn.exec_params(Queries::DELETE_GRADE, id);
-        txn.commit();
+        // COPY ... TO STDOUT: строки приходят по одной, таблица в памяти не собирается
+        pqxx::stream_from stream(txn, "student_grades", std::vector<std::string>{
+            "id", "student_id", "subject", "grade", "semester",
+            "attendance_percent", "assignment_completion", "exam_result"});
+        
+        std::string line;
+        Grade grade;
+        GradeExport::Nulls::Mask nulls = GradeExport::Nulls::NONE;
+        while (stream.get_raw_line(line)) {
+            if (!GradeExport::parseCopyLine(line, grade, nulls)) {
+                // Пропуск строки дал бы неполную выгрузку, похожую на полную
+                LOG_ERROR("exportGrades: unparsable COPY line", {{"line", line}});
+                return false;
+            }
+            if (!visit(grade, nulls)) {
+                // Клиент отключился; остаток COPY дочитает деструктор stream_from
+                return true;
+            }
+        }
+        stream.complete();
         return true;
     } catch (const std::exception& e) {
-        std::cerr << "Database error: " << e.what() << std::endl;
+        LOG_ERROR("Database error in exportGrades", {{"error", e.what()}});
         return false;
     }
 }
 
-std::string Database::predictExamSuccess(int student_id) {
+ImportReport Database::importGrades(ImportFormat format, bool skip_invalid, const BodyReader& read_body) {
+    ImportReport report;
     try {
-        std::vector<Grade> grades = getStudentGrades(student_id);
+        auto conn = pool.acquire();
+        pqxx::work txn(*conn);
+        execQuery(txn, Queries::Id::BEGIN_BULK_IMPORT);
         
-        if (grades.empty()) {
-            return "Недостаточно данных для прогноза";
+        // Внешний ключ проверяем сами: ошибка COPY отменила бы загрузку без номера строки
+        std::unordered_set<int> student_ids;
+        pqxx::result ids = execQuery(txn, Queries::Id::GET_ALL_STUDENT_IDS);
+        student_ids.reserve(ids.size());
+        for (auto row : ids) {
+            student_ids.insert(row[0].as<int>());
         }
         
-        double avgGrade = 0.0;
-        double avgAttendance = 0.0;
-        double avgAssignment = 0.0;
-        int count = 0;
+        pqxx::stream_to stream(txn, "student_grades", std::vector<std::string>{
+            "student_id", "subject", "grade", "semester",
+            "attendance_percent", "assignment_completion", "exam_result"});
         
-        for (const auto& grade : grades) {
-            avgGrade += grade.grade;
-            avgAttendance += grade.attendance_percent;
-            avgAssignment += grade.assignment_completion;
-            count++;
+        GradeImportParser parser(format,
+            [&](size_t line, const Grade& g) {
+                report.rows++;
+                if (student_ids.count(g.student_id) == 0) {
+                    report.addError(line, "студент " + std::to_string(g.student_id) + " не найден");
+                    return;
+                }
+                // Без skip_invalid после первой ошибки строки только проверяются
+                if (skip_invalid || report.error_count == 0) {
+                    stream << std::make_tuple(g.student_id, g.subject, g.grade, g.semester,
+                                              g.attendance_percent, g.assignment_completion, g.exam_result);
+                    report.imported++;
+                }
+            },
+            [&](size_t line, const std::string& message) {
+                report.rows++;
+                report.addError(line, message);
+            });
+        
+        // Ошибка записи в COPY не должна пройти сквозь код HTTP-сервера:
+        // запоминаем ее и прекращаем чтение тела
+        std::string stream_error;
+        bool complete = read_body([&](const char* data, size_t size) {
+            try {
+                parser.feed(data, size);
+                return true;
+            } catch (const std::exception& e) {
+                stream_error = e.what();
+                return false;
+            }
+        });
+        if (!stream_error.empty()) {
+            throw std::runtime_error(stream_error);
         }
+        if (!complete) {
+            report.failure = "тело запроса получено не полностью";
+            report.imported = 0;
+            return report;
+        }
+        parser.finish();
+        stream.complete();
         
-        if (count > 0) {
-            avgGrade /= count;
-            avgAttendance /= count;
-            avgAssignment /= count;
+        if (report.error_count > 0 && !skip_invalid) {
+            // Транзакция откатится при выходе
+            report.imported = 0;
+            return report;
         }
         
-        // Простая формула прогноза: средние оценки * веса посещаемости и выполнения заданий
-        double prediction_score = (avgGrade * 0.5) + (avgAttendance / 20.0 * 0.25) + (avgAssignment / 20.0 * 0.25);
+        execQuery(txn, Queries::Id::NOTIFY_GRADES_RELOAD);
+        txn.commit();
+        report.committed = true;
+    } catch (const std::exception& e) {
+        LOG_ERROR("Database error in importGrades", {{"error", e.what()}});
+        report.failure = e.what();
+        report.imported = 0;
+        report.committed = false;
+        return report;
+    }
+    
+    // Новых строк может быть очень много - проще перечитать таблицу при следующем запросе
+    cache.invalidate();
+    LOG_INFO("Grades imported", {{"imported", report.imported}, {"skipped", report.error_count}});
+    return report;
+}
+
+std::string Database::predictExamSuccess(int student_id) {
+    try {
+        if (!cache_enabled) {
+            return Predictor::describe(Predictor::predictStudent(student_id, loadStudentGrades(student_id)));
+        }
         
-        std::string result;
-        if (prediction_score >= 4.5) {
-            result = "Отлично (5) - вероятность: " + std::to_string((int)(prediction_score * 20)) + "%";
-        } else if (prediction_score >= 3.5) {
-            result = "Хорошо (4) - вероятность: " + std::to_string((int)(prediction_score * 20)) + "%";
-        } else if (prediction_score >= 2.5) {
-            result = "Удовлетворительно (3) - вероятность: " + std::to_string((int)(prediction_score * 18)) + "%";
-        } else {
-            result = "Неудовлетворительно (2) - вероятность: " + std::to_string((int)((5.0 - prediction_score) * 15)) + "%";
+        // Суммы по оценкам студента поддерживаются кэшем при каждом изменении,
+        // поэтому прогноз не зависит от числа оценок студента
+        auto snapshot = getGradesSnapshot();
+        const StudentGrades* student = snapshot->find(student_id);
+        if (!student) {
+            return Predictor::describe(Predictor::fromSums(student_id, 0.0, 0.0, 0.0, 0));
         }
         
-        return result;
+        const StudentAggregate& aggregate = student->aggregate;
+        return Predictor::describe(Predictor::fromSums(student_id, aggregate.sum_grade, aggregate.sum_attendance,
+                                                       aggregate.sum_assignment, aggregate.count));
     } catch (const std::exception& e) {
-        std::cerr << "Prediction error: " << e.what() << std::endl;
+        LOG_ERROR("Prediction error", {{"error", e.what()}});
         return "Ошибка при расчете прогноза";
     }
 }
 
+std::vector<Prediction> Database::predictBatch(const std::vector<int>& student_ids) {
+    // Пустой список - все студенты
+    bool all = student_ids.empty();
+    std::vector<int> ids = student_ids;
+    if (all) {
+        auto students = getStudentsSnapshot();
+        ids.reserve(students->count);
+        students->forEach([&](const Student& student) {
+            ids.push_back(student.id);
+            return true;
+        });
+    } else {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+    
+    // Без кэша для явного списка читаются только оценки этих студентов, а не вся таблица
+    std::shared_ptr<const GradesSnapshot> snapshot;
+    if (!all && !cache_enabled) {
+        try {
+            snapshot = DataCache::makeGradesSnapshot(loadGradesForStudents(ids));
+        } catch (const std::exception& e) {
+            LOG_ERROR("Database error in predictBatch", {{"error", e.what()}});
+            snapshot = std::make_shared<const GradesSnapshot>();
+        }
+    } else {
+        snapshot = getGradesSnapshot();
+    }
+    
+    // Суммы по строкам студента в снимке уже посчитаны (в том же порядке строк, что и
+    // в predictAll), поэтому прогноз - O(1) на студента, без прохода по оценкам.
+    // Студенты без оценок тоже попадают в ответ (has_data = false)
+    std::vector<Prediction> result;
+    result.reserve(ids.size());
+    for (int id : ids) {
+        const StudentGrades* student = snapshot->find(id);
+        if (!student) {
+            Prediction empty;
+            empty.student_id = id;
+            result.push_back(empty);
+            continue;
+        }
+        const StudentAggregate& aggregate = student->aggregate;
+        result.push_back(Predictor::fromSums(id, aggregate.sum_grade, aggregate.sum_attendance,
+                                             aggregate.sum_assignment, aggregate.count));
+    }
+    return result;
+}
+
+std::vector<Prediction> Database::predictGroup(const std::string& group_name) {
+    std::vector<int> ids;
+    getStudentsSnapshot()->forEach([&](const Student& student) {
+        if (student.group_name == group_name) {
+            ids.push_back(student.id);
+        }
+        return true;
+    });
+    if (ids.empty()) {
+        return {};
+    }
+    return predictBatch(ids);
+}
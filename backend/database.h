@@ -6,47 +6,145 @@
 #include <vector>
 #include <memory>
 #include <iostream>
+#include <functional>
+#include <optional>
+#include <mutex>
+#include <unordered_map>
+#include "models.h"
+#include "connection_pool.h"
+#include "data_cache.h"
+#include "change_listener.h"
+#include "prediction.h"
+#include "grade_import.h"
+#include "grade_export.h"
+#include "write_batcher.h"
+#include "hashing_pool.h"
 
-struct Student {
-    int id;
-    std::string name;
-    std::string surname;
-    std::string group_name;
+// Запрос страницы студентов: id > after_id по возрастанию id, не больше limit строк
+struct StudentPageQuery {
+    int after_id = 0;
+    long limit = 100;
+    std::string group_name;     // Пусто - все группы
 };
 
-struct Grade {
-    int id;
-    int student_id;
+// Запрос страницы оценок; 0 и пустая строка - без фильтра
+struct GradePageQuery {
+    int after_id = 0;
+    long limit = 100;
+    int student_id = 0;
     std::string subject;
-    int grade;
-    int semester;
-    double attendance_percent;
-    double assignment_completion;
-    int exam_result;
+    int semester = 0;
 };
 
-struct User {
-    int id;
-    std::string username;
-    std::string email;
-    std::string role;
+// Результат регистрации пользователя
+enum class RegisterResult {
+    Created,
+    UsernameTaken,
+    EmailTaken,
+    Taken,          // Имя или email заняты параллельной регистрацией (какое именно - неизвестно)
+    Overloaded,     // Очередь пула хеширования заполнена (клиенту нужно ответить 503)
+    Error
 };
 
 class Database {
 private:
     std::string connection_string;
+    const std::string instance_id;      // app.instance соединений: метка своих уведомлений об изменениях
+    ConnectionPool pool;
+    DataCache cache;
+    bool cache_enabled;
+    std::unique_ptr<ChangeListener> listener;
+    
+    // Свои изменения строк: поправка кэша после коммита и уведомление о той же транзакции
+    // приходят в любом порядке. Ключ - "<таблица>:<id>:<транзакция>". pending - поправка
+    // применена, уведомление еще не обработано; notified - наоборот: поправка опоздала,
+    // строка уже перечитана после коммита, и старое значение применять нельзя
+    std::mutex own_changes_mutex;
+    std::unordered_map<std::string, int> own_pending;
+    std::unordered_map<std::string, int> own_notified;
+    std::unique_ptr<WriteBatcher> batcher;      // nullptr - каждая запись в своей транзакции
+    std::unique_ptr<HashingPool> hasher;        // nullptr - хеши считаются в потоке запроса
+    
+    // Полная загрузка таблиц из БД (бросают исключения)
+    std::vector<Student> loadAllStudents();
+    std::vector<Grade> loadAllGrades();
+    std::vector<Grade> loadStudentGrades(int student_id);
+    std::vector<Grade> loadGradesForStudents(const std::vector<int>& student_ids);
+    
+    // Выполнить изменение: через групповой коммит, если он включен, иначе в своей транзакции.
+    // Возвращает false, если изменение не сохранено
+    bool runWrite(const WriteBatcher::Operation& op);
+    
+    // Посчитать хеш пароля в пуле хеширования, если он включен. false - очередь заполнена
+    bool runHashing(const std::function<void()>& job);
+    void upgradePasswordHash(int user_id, const std::string& old_hash, const std::string& new_hash);
+    
+    // Вставить пользователя одним запросом (INSERT ... ON CONFLICT DO NOTHING)
+    RegisterResult insertUser(pqxx::transaction_base& txn, const std::string& username,
+                              const std::string& password_hash, const std::string& email, const std::string& role);
+    
+    // Новое соединение: подготовить все запросы из Queries и задать app.instance
+    void setupConnection(pqxx::connection& conn);
+    
+    // Поправка кэша после коммита своего изменения строки table/id в транзакции txid.
+    // Не применяется, если уведомление об этой транзакции уже обработано
+    void patchOwnChange(const std::string& table, int id, int64_t txid, const std::function<void()>& patch);
+    // Сбросить кэш и учет своих изменений (уведомления потеряны)
+    void resyncCache();
     
 public:
-    Database(const std::string& conn_str);
+    // cache_enabled = false: все чтения идут в БД, большие списки читаются курсором
+    // (память не зависит от размера таблиц)
+    Database(const std::string& conn_str, const PoolConfig& pool_config = PoolConfig(), bool cache_enabled = true);
     ~Database();
     
-    // Пользователи
-    bool registerUser(const std::string& username, const std::string& password, const std::string& email);
-    bool registerUserWithRole(const std::string& username, const std::string& password, const std::string& email, const std::string& role);
-    User* authenticateUser(const std::string& username, const std::string& password);
-    bool isAdmin(int user_id);
+    // Счетчики пула соединений
+    PoolStats getPoolStats() const;
+    
+    // Пользователи. overloaded = true: вход отклонен, потому что очередь
+    // пула хеширования заполнена (клиенту нужно ответить 503)
+    RegisterResult registerUser(const std::string& username, const std::string& password, const std::string& email);
+    RegisterResult registerUserWithRole(const std::string& username, const std::string& password, const std::string& email, const std::string& role);
+    std::optional<User> authenticateUser(const std::string& username, const std::string& password,
+                                         bool& overloaded);
     bool createDefaultAdmin(); // Создать тестового админа (admin/admin)
     
+    // Снимки из кэша (при пустом кэше загружаются из БД).
+    // При ошибке БД возвращается пустой снимок, который не кэшируется
+    std::shared_ptr<const StudentsSnapshot> getStudentsSnapshot();
+    std::shared_ptr<const GradesSnapshot> getGradesSnapshot();
+    uint64_t getDataVersion() const;
+    // Метка текущей версии студентов и оценок (для ETag): меняется при каждом изменении,
+    // в том числе сделанном другим экземпляром. С кэшем - версия кэша этого экземпляра
+    // (у каждого экземпляра своя), без кэша - общая последовательность data_version из БД.
+    // Пустая строка при ошибке БД
+    std::string getDataTag();
+    bool isCacheEnabled() const { return cache_enabled; }
+    
+    // Обход всех студентов/оценок по порядку без копирования таблицы целиком:
+    // из снимка кэша или курсором из БД порциями. visit возвращает false, чтобы прервать обход.
+    // Возвращает false при ошибке БД
+    bool forEachStudent(const std::function<bool(const Student&)>& visit);
+    bool forEachGrade(const std::function<bool(const Grade&)>& visit);
+    
+    // Страница по ключу (seek) прямо из БД по составному индексу (фильтр, id):
+    // стоимость страницы не зависит от того, насколько она далеко от начала.
+    // has_more - после страницы есть еще строки. Возвращает false при ошибке БД
+    bool getStudentsPage(const StudentPageQuery& query, std::vector<Student>& page, bool& has_more);
+    bool getGradesPage(const GradePageQuery& query, std::vector<Grade>& page, bool& has_more);
+    
+    // Синхронизация кэша с другими экземплярами сервера через LISTEN/NOTIFY
+    void startChangeListener();
+    void applyChange(const DataChange& change);
+    
+    // Групповой коммит изменений студентов и оценок (см. WriteBatcher)
+    void enableWriteBatching(const WriteBatchConfig& config = WriteBatchConfig());
+    WriteBatchStats getWriteBatchStats() const;
+    
+    // Отдельный ограниченный пул потоков для хеширования паролей (см. HashingPool)
+    void enableHashingPool(const HashingPoolConfig& config = HashingPoolConfig());
+    HashingPoolStats getHashingStats() const;
+    
     // Студенты
     std::vector<Student> getAllStudents();
     bool addStudent(const std::string& name, const std::string& surname, const std::string& group_name);
@@ -62,8 +160,21 @@ public:
                      double attendance, double assignment, int exam_result);
     bool deleteGrade(int id);
     
+    // Выгрузка всей таблицы оценок через COPY (в порядке хранения, без сортировки).
+    // visit возвращает false, чтобы прервать выгрузку. Возвращает false при ошибке БД
+    bool exportGrades(const std::function<bool(const Grade&, GradeExport::Nulls::Mask)>& visit);
+    
+    // Массовая загрузка оценок через COPY в одной транзакции.
+    // read_body передает тело запроса кусками в receiver (возвращает false, если тело оборвалось).
+    // skip_invalid = false: при любой ошибке в данных ничего не записывается
+    using BodyReader = std::function<bool(const std::function<bool(const char*, size_t)>& receiver)>;
+    ImportReport importGrades(ImportFormat format, bool skip_invalid, const BodyReader& read_body);
+    
     // Прогноз
     std::string predictExamSuccess(int student_id);
+    // Прогноз сразу для многих студентов за один проход (пустой список - все студенты)
+    std::vector<Prediction> predictBatch(const std::vector<int>& student_ids);
+    std::vector<Prediction> predictGroup(const std::string& group_name);
 };
 
 #endif
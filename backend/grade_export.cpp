@@ -0,0 +1,273 @@
+#include "grade_export.h"
+#include "number_format.h"
+#include <charconv>
+#include <cstring>
+
+// Столбцы пишутся как есть из памяти - формат определен как little-endian
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "GradeColumnarWriter: нужна little-endian платформа");
+
+namespace {
+    const char FILE_MAGIC[8] = {'V', 'Z', 'G', 'R', 'A', 'D', 'E', 'S'};
+
+    // Следующее поле строки COPY начиная с pos (без разбора экранирования)
+    bool nextField(const std::string& line, size_t& pos, const char*& begin, size_t& size) {
+        if (pos > line.size()) {
+            return false;
+        }
+        size_t tab = line.find('\t', pos);
+        size_t end = tab == std::string::npos ? line.size() : tab;
+        begin = line.data() + pos;
+        size = end - pos;
+        pos = end + 1;
+        return true;
+    }
+
+    bool isNull(const char* data, size_t size) {
+        return size == 2 && data[0] == '\\' && data[1] == 'N';
+    }
+
+    bool toInt(const char* data, size_t size, int& out) {
+        auto result = std::from_chars(data, data + size, out);
+        return result.ec == std::errc() && result.ptr == data + size && size > 0;
+    }
+
+    bool toDouble(const char* data, size_t size, double& out) {
+        return NumberFormat::read(data, data + size, out);
+    }
+
+    int octalDigit(char c) {
+        return (c >= '0' && c <= '7') ? c - '0' : -1;
+    }
+
+    int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // Текстовое поле COPY: \\, \t, \n, \r, \b, \f, \v, \ooo, \xhh
+    void unescapeCopy(const char* data, size_t size, std::string& out) {
+        out.clear();
+        out.reserve(size);
+        for (size_t i = 0; i < size; i++) {
+            char c = data[i];
+            if (c != '\\' || i + 1 == size) {
+                out.push_back(c);
+                continue;
+            }
+            char e = data[++i];
+            switch (e) {
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'v': out.push_back('\v'); break;
+                case 'x': {
+                    int value = 0;
+                    int digits = 0;
+                    while (digits < 2 && i + 1 < size && hexDigit(data[i + 1]) >= 0) {
+                        value = value * 16 + hexDigit(data[++i]);
+                        digits++;
+                    }
+                    out.push_back(digits ? (char)value : 'x');
+                    break;
+                }
+                default:
+                    if (octalDigit(e) >= 0) {
+                        int value = octalDigit(e);
+                        for (int digits = 1; digits < 3 && i + 1 < size && octalDigit(data[i + 1]) >= 0; digits++) {
+                            value = value * 8 + octalDigit(data[++i]);
+                        }
+                        out.push_back((char)value);
+                    } else {
+                        out.push_back(e);   // В том числе \\ -> '\'
+                    }
+            }
+        }
+    }
+
+    void appendCsvField(std::string& out, const std::string& value) {
+        if (value.find_first_of(",\"\r\n") == std::string::npos) {
+            out += value;
+            return;
+        }
+        out.push_back('"');
+        for (char c : value) {
+            if (c == '"') {
+                out.push_back('"');
+            }
+            out.push_back(c);
+        }
+        out.push_back('"');
+    }
+
+    template<typename T>
+    void appendNumber(std::string& out, T value) {
+        char buf[NumberFormat::BUFFER_SIZE];
+        out.append(buf, NumberFormat::write(buf, value) - buf);
+    }
+
+    template<typename T>
+    void appendRaw(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+}
+
+namespace GradeExport {
+    bool parseCopyLine(const std::string& line, Grade& grade, Nulls::Mask& nulls) {
+        size_t pos = 0;
+        const char* data = nullptr;
+        size_t size = 0;
+        nulls = Nulls::NONE;
+
+        // Необязательное поле: NULL оставляет 0 и ставит бит в nulls
+        auto nullable = [&](auto& value, Nulls::Mask bit, auto convert) {
+            value = 0;
+            if (isNull(data, size)) {
+                nulls |= bit;
+                return true;
+            }
+            return convert(data, size, value);
+        };
+
+        if (!nextField(line, pos, data, size) || !toInt(data, size, grade.id)) return false;
+        if (!nextField(line, pos, data, size) || !nullable(grade.student_id, Nulls::STUDENT_ID, toInt)) return false;
+        if (!nextField(line, pos, data, size)) return false;
+        unescapeCopy(data, size, grade.subject);
+        if (!nextField(line, pos, data, size) || !nullable(grade.grade, Nulls::GRADE, toInt)) return false;
+        if (!nextField(line, pos, data, size) || !toInt(data, size, grade.semester)) return false;
+        if (!nextField(line, pos, data, size) ||
+            !nullable(grade.attendance_percent, Nulls::ATTENDANCE, toDouble)) return false;
+        if (!nextField(line, pos, data, size) ||
+            !nullable(grade.assignment_completion, Nulls::ASSIGNMENT, toDouble)) return false;
+        if (!nextField(line, pos, data, size) || !nullable(grade.exam_result, Nulls::EXAM_RESULT, toInt)) return false;
+        return pos > line.size();   // Лишних полей нет
+    }
+
+    void writeCsvHeader(std::string& out) {
+        out += "id,student_id,subject,grade,semester,attendance_percent,assignment_completion,exam_result\n";
+    }
+
+    void writeCsvRow(std::string& out, const Grade& g, Nulls::Mask nulls) {
+        // Значение столбца или пустая ячейка для NULL, затем разделитель
+        auto cell = [&](auto value, Nulls::Mask bit, char separator) {
+            if (!(nulls & bit)) {
+                appendNumber(out, value);
+            }
+            out.push_back(separator);
+        };
+
+        appendNumber(out, g.id);
+        out.push_back(',');
+        cell(g.student_id, Nulls::STUDENT_ID, ',');
+        appendCsvField(out, g.subject);
+        out.push_back(',');
+        cell(g.grade, Nulls::GRADE, ',');
+        appendNumber(out, g.semester);
+        out.push_back(',');
+        cell(g.attendance_percent, Nulls::ATTENDANCE, ',');
+        cell(g.assignment_completion, Nulls::ASSIGNMENT, ',');
+        cell(g.exam_result, Nulls::EXAM_RESULT, '\n');
+    }
+
+    bool parseFormat(const std::string& name, ExportFormat& format) {
+        if (name.empty() || name == "csv") {
+            format = ExportFormat::Csv;
+            return true;
+        }
+        if (name == "binary" || name == "columnar") {
+            format = ExportFormat::Columnar;
+            return true;
+        }
+        return false;
+    }
+}
+
+GradeColumnarWriter::GradeColumnarWriter(size_t block_rows) : block_rows(block_rows ? block_rows : 1) {
+    id.reserve(this->block_rows);
+    student_id.reserve(this->block_rows);
+    grade.reserve(this->block_rows);
+    semester.reserve(this->block_rows);
+    exam_result.reserve(this->block_rows);
+    attendance.reserve(this->block_rows);
+    assignment.reserve(this->block_rows);
+    subject_offsets.reserve(this->block_rows + 1);
+    subject_offsets.push_back(0);
+    nulls.reserve(this->block_rows);
+    validity.reserve((this->block_rows + 7) / 8);
+}
+
+void GradeColumnarWriter::writeFileHeader(std::string& out) {
+    out.append(FILE_MAGIC, sizeof(FILE_MAGIC));
+    appendRaw<uint32_t>(out, VERSION);
+    appendRaw<uint32_t>(out, COLUMN_COUNT);
+}
+
+void GradeColumnarWriter::writeFileTrailer(std::string& out) {
+    appendRaw<uint64_t>(out, 0);
+}
+
+void GradeColumnarWriter::appendArray(std::string& out, const void* data, size_t bytes) {
+    appendRaw<uint64_t>(out, bytes);
+    out.append(static_cast<const char*>(data), bytes);
+    size_t padding = (8 - bytes % 8) % 8;
+    out.append(padding, '\0');
+}
+
+void GradeColumnarWriter::appendValidity(std::string& out, GradeExport::Nulls::Mask column) {
+    validity.assign((nulls.size() + 7) / 8, '\0');
+    for (size_t i = 0; i < nulls.size(); i++) {
+        if (!(nulls[i] & column)) {
+            validity[i / 8] |= (char)(1u << (i % 8));
+        }
+    }
+    appendArray(out, validity.data(), validity.size());
+}
+
+void GradeColumnarWriter::add(const Grade& g, GradeExport::Nulls::Mask row_nulls) {
+    id.push_back(g.id);
+    student_id.push_back(g.student_id);
+    grade.push_back(g.grade);
+    semester.push_back(g.semester);
+    exam_result.push_back(g.exam_result);
+    attendance.push_back(g.attendance_percent);
+    assignment.push_back(g.assignment_completion);
+    subject_data += g.subject;
+    subject_offsets.push_back((uint32_t)subject_data.size());
+    nulls.push_back(row_nulls);
+}
+
+void GradeColumnarWriter::flushBlock(std::string& out) {
+    if (id.empty()) {
+        return;
+    }
+    appendRaw<uint64_t>(out, id.size());
+    appendArray(out, id.data(), id.size() * sizeof(int32_t));
+    appendArray(out, student_id.data(), student_id.size() * sizeof(int32_t));
+    appendArray(out, grade.data(), grade.size() * sizeof(int32_t));
+    appendArray(out, semester.data(), semester.size() * sizeof(int32_t));
+    appendArray(out, exam_result.data(), exam_result.size() * sizeof(int32_t));
+    appendArray(out, attendance.data(), attendance.size() * sizeof(double));
+    appendArray(out, assignment.data(), assignment.size() * sizeof(double));
+    appendArray(out, subject_offsets.data(), subject_offsets.size() * sizeof(uint32_t));
+    appendArray(out, subject_data.data(), subject_data.size());
+    appendValidity(out, GradeExport::Nulls::STUDENT_ID);
+    appendValidity(out, GradeExport::Nulls::GRADE);
+    appendValidity(out, GradeExport::Nulls::EXAM_RESULT);
+    appendValidity(out, GradeExport::Nulls::ATTENDANCE);
+    appendValidity(out, GradeExport::Nulls::ASSIGNMENT);
+
+    id.clear();
+    student_id.clear();
+    grade.clear();
+    semester.clear();
+    exam_result.clear();
+    attendance.clear();
+    assignment.clear();
+    subject_offsets.clear();
+    subject_offsets.push_back(0);
+    subject_data.clear();
+    nulls.clear();
+}
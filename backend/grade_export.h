@@ -0,0 +1,108 @@
+#ifndef GRADE_EXPORT_H
+#define GRADE_EXPORT_H
+
+#include "models.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Формат выгрузки /api/export
+enum class ExportFormat {
+    Csv,
+    Columnar    // Двоичный столбцовый формат (см. GradeColumnarWriter)
+};
+
+namespace GradeExport {
+    // Столбцы строки выгрузки, равные NULL (там, где NULL допустим)
+    namespace Nulls {
+        using Mask = uint8_t;
+
+        constexpr Mask NONE = 0;
+        constexpr Mask STUDENT_ID = 1u << 0;
+        constexpr Mask GRADE = 1u << 1;
+        constexpr Mask ATTENDANCE = 1u << 2;
+        constexpr Mask ASSIGNMENT = 1u << 3;
+        constexpr Mask EXAM_RESULT = 1u << 4;
+    }
+
+    // Строка COPY ... TO STDOUT в текстовом формате (поля через \t, NULL = \N)
+    // со столбцами id, student_id, subject, grade, semester, attendance_percent,
+    // assignment_completion, exam_result. NULL дает 0 в grade и бит в nulls
+    bool parseCopyLine(const std::string& line, Grade& grade, Nulls::Mask& nulls);
+
+    // Заголовок CSV и одна строка CSV (с переводом строки); NULL - пустая ячейка
+    void writeCsvHeader(std::string& out);
+    void writeCsvRow(std::string& out, const Grade& grade, Nulls::Mask nulls);
+
+    // Формат по имени ("csv", "binary"); false, если не распознан
+    bool parseFormat(const std::string& name, ExportFormat& format);
+}
+
+// Двоичный столбцовый формат выгрузки оценок. Все числа little-endian,
+// каждый массив начинается с границы 8 байт от начала файла, поэтому после mmap
+// столбцы читаются как обычные массивы без копирования и разбора.
+//
+//   Заголовок файла (16 байт):
+//     char[8]  magic = "VZGRADES"
+//     uint32   version = 2
+//     uint32   column_count = 8
+//   Блоки, пока row_count != 0:
+//     uint64   row_count (0 - конец файла; без него выгрузка оборвалась)
+//     14 массивов (subject занимает два), каждый: uint64 длина в байтах, данные,
+//     выравнивание нулями до 8 байт
+//       int32[row_count]       id
+//       int32[row_count]       student_id
+//       int32[row_count]       grade
+//       int32[row_count]       semester
+//       int32[row_count]       exam_result
+//       float64[row_count]     attendance_percent
+//       float64[row_count]     assignment_completion
+//       uint32[row_count + 1]  subject_offsets
+//       uint8[]                subject_data: строки subject (UTF-8) подряд,
+//                              i-я строка - [offsets[i], offsets[i + 1])
+//       uint8[(row_count + 7) / 8] валидность student_id, grade, exam_result,
+//                              attendance_percent, assignment_completion (пять массивов
+//                              в этом порядке): бит i % 8 байта i / 8 равен 1, если значение
+//                              в строке i есть, и 0 для NULL (в самом столбце тогда 0)
+//
+// Блоки ограничены по числу строк, так что память на выгрузку не зависит от размера таблицы.
+class GradeColumnarWriter {
+public:
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint32_t COLUMN_COUNT = 8;
+    static constexpr size_t DEFAULT_BLOCK_ROWS = 64 * 1024;
+
+private:
+    size_t block_rows;
+
+    std::vector<int32_t> id;
+    std::vector<int32_t> student_id;
+    std::vector<int32_t> grade;
+    std::vector<int32_t> semester;
+    std::vector<int32_t> exam_result;
+    std::vector<double> attendance;
+    std::vector<double> assignment;
+    std::vector<uint32_t> subject_offsets;
+    std::string subject_data;
+    std::vector<GradeExport::Nulls::Mask> nulls;
+    std::string validity;       // Буфер одного массива валидности
+
+    static void appendArray(std::string& out, const void* data, size_t bytes);
+    void appendValidity(std::string& out, GradeExport::Nulls::Mask column);
+
+public:
+    explicit GradeColumnarWriter(size_t block_rows = DEFAULT_BLOCK_ROWS);
+
+    static void writeFileHeader(std::string& out);
+    static void writeFileTrailer(std::string& out);     // Блок с row_count = 0
+
+    void add(const Grade& g, GradeExport::Nulls::Mask nulls);
+    size_t rows() const { return id.size(); }
+    bool full() const { return id.size() >= block_rows; }
+
+    // Дописать накопленные строки блоком в out и очистить буферы (память сохраняется)
+    void flushBlock(std::string& out);
+};
+
+#endif
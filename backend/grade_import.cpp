@@ -0,0 +1,437 @@
+#include "grade_import.h"
+#include "number_format.h"
+#include <charconv>
+#include <cstring>
+#include <cmath>
+#include <utility>
+
+namespace {
+    const size_t FIELD_COUNT = 7;
+
+    // Порядок столбцов CSV и имена полей NDJSON
+    const char* const FIELD_NAMES[FIELD_COUNT] = {
+        "student_id", "subject", "grade", "semester",
+        "attendance_percent", "assignment_completion", "exam_result"
+    };
+
+    const size_t MAX_SUBJECT_CHARS = 100;   // subject VARCHAR(100) - символы, а не байты
+
+    // Число символов UTF-8 (байты продолжения 10xxxxxx не считаются)
+    size_t utf8Length(const std::string& text) {
+        size_t length = 0;
+        for (unsigned char c : text) {
+            if ((c & 0xC0) != 0x80) {
+                length++;
+            }
+        }
+        return length;
+    }
+
+    bool parseInt(const std::string& text, int& out) {
+        const char* first = text.data();
+        const char* last = first + text.size();
+        auto result = std::from_chars(first, last, out);
+        return result.ec == std::errc() && result.ptr == last && !text.empty();
+    }
+
+    bool parseDouble(const std::string& text, double& out) {
+        return NumberFormat::read(text.data(), text.data() + text.size(), out) && std::isfinite(out);
+    }
+
+    // Заполнить оценку из текстовых значений полей (в порядке FIELD_NAMES)
+    bool fromFields(const std::string (&fields)[FIELD_COUNT], Grade& grade, std::string& error) {
+        grade.id = 0;
+        if (!parseInt(fields[0], grade.student_id)) {
+            error = "student_id: ожидается целое число";
+            return false;
+        }
+        grade.subject = fields[1];
+        if (!parseInt(fields[2], grade.grade)) {
+            error = "grade: ожидается целое число";
+            return false;
+        }
+        if (!parseInt(fields[3], grade.semester)) {
+            error = "semester: ожидается целое число";
+            return false;
+        }
+        if (!parseDouble(fields[4], grade.attendance_percent)) {
+            error = "attendance_percent: ожидается число";
+            return false;
+        }
+        if (!parseDouble(fields[5], grade.assignment_completion)) {
+            error = "assignment_completion: ожидается число";
+            return false;
+        }
+        if (!parseInt(fields[6], grade.exam_result)) {
+            error = "exam_result: ожидается целое число";
+            return false;
+        }
+        return GradeImportParser::validate(grade, error);
+    }
+
+    // Поле CSV, начиная с pos; поддерживаются кавычки ("" внутри - одна кавычка).
+    // После вызова pos указывает на разделитель или конец строки
+    bool readCsvField(const char* data, size_t size, size_t& pos, std::string& out) {
+        out.clear();
+        if (pos < size && data[pos] == '"') {
+            pos++;
+            while (pos < size) {
+                if (data[pos] == '"') {
+                    if (pos + 1 < size && data[pos + 1] == '"') {
+                        out.push_back('"');
+                        pos += 2;
+                        continue;
+                    }
+                    pos++;
+                    return pos == size || data[pos] == ',';
+                }
+                out.push_back(data[pos++]);
+            }
+            return false;   // Нет закрывающей кавычки
+        }
+        size_t start = pos;
+        while (pos < size && data[pos] != ',') {
+            pos++;
+        }
+        out.assign(data + start, pos - start);
+        return true;
+    }
+
+    // Минимальный разбор плоского JSON-объекта для NDJSON
+    class JsonLine {
+    private:
+        const char* p;
+        const char* end;
+
+        void skipSpaces() {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+                p++;
+            }
+        }
+
+        static void appendUtf8(std::string& out, unsigned code) {
+            if (code < 0x80) {
+                out.push_back((char)code);
+            } else if (code < 0x800) {
+                out.push_back((char)(0xC0 | (code >> 6)));
+                out.push_back((char)(0x80 | (code & 0x3F)));
+            } else if (code < 0x10000) {
+                out.push_back((char)(0xE0 | (code >> 12)));
+                out.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back((char)(0x80 | (code & 0x3F)));
+            } else {
+                out.push_back((char)(0xF0 | (code >> 18)));
+                out.push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+                out.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back((char)(0x80 | (code & 0x3F)));
+            }
+        }
+
+        bool readHex4(unsigned& code) {
+            if (end - p < 4) {
+                return false;
+            }
+            auto result = std::from_chars(p, p + 4, code, 16);
+            if (result.ptr != p + 4) {
+                return false;
+            }
+            p += 4;
+            return true;
+        }
+
+    public:
+        JsonLine(const char* data, size_t size) : p(data), end(data + size) {}
+
+        bool readString(std::string& out) {
+            out.clear();
+            if (p >= end || *p != '"') {
+                return false;
+            }
+            p++;
+            while (p < end) {
+                char c = *p++;
+                if (c == '"') {
+                    return true;
+                }
+                if (c != '\\') {
+                    out.push_back(c);
+                    continue;
+                }
+                if (p >= end) {
+                    return false;
+                }
+                char e = *p++;
+                switch (e) {
+                    case '"': out.push_back('"'); break;
+                    case '\\': out.push_back('\\'); break;
+                    case '/': out.push_back('/'); break;
+                    case 'b': out.push_back('\b'); break;
+                    case 'f': out.push_back('\f'); break;
+                    case 'n': out.push_back('\n'); break;
+                    case 'r': out.push_back('\r'); break;
+                    case 't': out.push_back('\t'); break;
+                    case 'u': {
+                        unsigned code = 0;
+                        if (!readHex4(code)) {
+                            return false;
+                        }
+                        // Суррогатная пара
+                        if (code >= 0xD800 && code < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                            p += 2;
+                            unsigned low = 0;
+                            if (!readHex4(low) || low < 0xDC00 || low >= 0xE000) {
+                                return false;
+                            }
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        appendUtf8(out, code);
+                        break;
+                    }
+                    default:
+                        return false;
+                }
+            }
+            return false;
+        }
+
+        // Значение: строка, число (текст как есть), null/true/false.
+        // is_string - значение было строкой в кавычках
+        bool readValue(std::string& out, bool& is_string) {
+            skipSpaces();
+            is_string = false;
+            if (p < end && *p == '"') {
+                is_string = true;
+                return readString(out);
+            }
+            const char* start = p;
+            while (p < end && *p != ',' && *p != '}' && *p != ' ' && *p != '\t' && *p != '\r') {
+                p++;
+            }
+            out.assign(start, p - start);
+            return !out.empty();
+        }
+
+        bool parse(std::string (&fields)[FIELD_COUNT], bool (&present)[FIELD_COUNT], std::string& error) {
+            skipSpaces();
+            if (p >= end || *p != '{') {
+                error = "ожидается JSON-объект";
+                return false;
+            }
+            p++;
+            skipSpaces();
+            if (p < end && *p == '}') {
+                p++;
+            } else {
+                std::string key;
+                std::string value;
+                while (true) {
+                    skipSpaces();
+                    if (!readString(key)) {
+                        error = "некорректное имя поля";
+                        return false;
+                    }
+                    skipSpaces();
+                    if (p >= end || *p != ':') {
+                        error = "ожидается ':' после имени поля";
+                        return false;
+                    }
+                    p++;
+                    bool is_string = false;
+                    if (!readValue(value, is_string)) {
+                        error = "некорректное значение поля " + key;
+                        return false;
+                    }
+                    for (size_t i = 0; i < FIELD_COUNT; i++) {
+                        if (key == FIELD_NAMES[i]) {
+                            // Строка допустима только для subject, null - ни для одного поля
+                            if ((i == 1) != is_string) {
+                                error = key + ": неверный тип значения";
+                                return false;
+                            }
+                            fields[i] = value;
+                            present[i] = true;
+                            break;
+                        }
+                    }
+                    skipSpaces();
+                    if (p < end && *p == ',') {
+                        p++;
+                        continue;
+                    }
+                    if (p < end && *p == '}') {
+                        p++;
+                        break;
+                    }
+                    error = "ожидается ',' или '}'";
+                    return false;
+                }
+            }
+            skipSpaces();
+            if (p != end) {
+                error = "лишние символы после объекта";
+                return false;
+            }
+            return true;
+        }
+    };
+}
+
+GradeImportParser::GradeImportParser(ImportFormat format, RowHandler on_row, ErrorHandler on_error)
+    : format(format), on_row(std::move(on_row)), on_error(std::move(on_error)) {}
+
+bool GradeImportParser::parseFormat(const std::string& name, ImportFormat& format) {
+    if (name == "csv" || name.rfind("text/csv", 0) == 0) {
+        format = ImportFormat::Csv;
+        return true;
+    }
+    if (name == "ndjson" || name == "jsonl" || name.rfind("application/x-ndjson", 0) == 0 ||
+        name.rfind("application/jsonl", 0) == 0) {
+        format = ImportFormat::Ndjson;
+        return true;
+    }
+    return false;
+}
+
+bool GradeImportParser::validate(const Grade& grade, std::string& error) {
+    if (grade.student_id <= 0) {
+        error = "student_id должен быть положительным";
+    } else if (grade.subject.empty() || utf8Length(grade.subject) > MAX_SUBJECT_CHARS) {
+        error = "subject: от 1 до 100 символов";
+    } else if (grade.grade < 1 || grade.grade > 5) {
+        error = "grade: от 1 до 5";
+    } else if (grade.attendance_percent < 0.0 || grade.attendance_percent > 100.0) {
+        error = "attendance_percent: от 0 до 100";
+    } else if (grade.assignment_completion < 0.0 || grade.assignment_completion > 100.0) {
+        error = "assignment_completion: от 0 до 100";
+    } else if (grade.exam_result < 1 || grade.exam_result > 5) {
+        error = "exam_result: от 1 до 5";
+    } else {
+        return true;
+    }
+    return false;
+}
+
+void GradeImportParser::feed(const char* data, size_t size) {
+    size_t pos = 0;
+    while (pos < size) {
+        const char* newline = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+        size_t chunk_end = newline ? (size_t)(newline - data) : size;
+
+        if (skipping_long_line) {
+            // Хвост слишком длинной строки, о которой уже сообщили
+        } else if (pending.size() + (chunk_end - pos) > MAX_LINE_BYTES) {
+            line++;
+            on_error(line, "строка длиннее " + std::to_string(MAX_LINE_BYTES) + " байт");
+            pending.clear();
+            skipping_long_line = true;
+        } else if (newline && pending.empty()) {
+            // Строка целиком в этом куске - без копирования
+            line++;
+            processLine(data + pos, chunk_end - pos);
+        } else {
+            pending.append(data + pos, chunk_end - pos);
+            if (newline) {
+                line++;
+                processLine(pending.data(), pending.size());
+                pending.clear();
+            }
+        }
+
+        if (!newline) {
+            break;
+        }
+        skipping_long_line = false;
+        pos = chunk_end + 1;
+    }
+}
+
+void GradeImportParser::finish() {
+    if (!pending.empty() && !skipping_long_line) {
+        line++;
+        processLine(pending.data(), pending.size());
+    }
+    pending.clear();
+    skipping_long_line = false;
+}
+
+void GradeImportParser::processLine(const char* data, size_t size) {
+    if (size > 0 && data[size - 1] == '\r') {
+        size--;
+    }
+    bool blank = true;
+    for (size_t i = 0; i < size; i++) {
+        if (data[i] != ' ' && data[i] != '\t') {
+            blank = false;
+            break;
+        }
+    }
+    if (blank) {
+        return;
+    }
+
+    // Необязательная строка заголовка CSV
+    if (format == ImportFormat::Csv && !header_checked) {
+        header_checked = true;
+        const char* name = FIELD_NAMES[0];
+        size_t name_size = std::strlen(name);
+        if (size >= name_size && std::memcmp(data, name, name_size) == 0) {
+            std::string expected;
+            for (size_t i = 0; i < FIELD_COUNT; i++) {
+                expected += (i ? "," : "");
+                expected += FIELD_NAMES[i];
+            }
+            if (std::string(data, size) != expected) {
+                on_error(line, "заголовок должен быть: " + expected);
+            }
+            return;
+        }
+    }
+
+    Grade grade;
+    std::string error;
+    bool ok = format == ImportFormat::Csv ? parseCsv(data, size, grade, error)
+                                          : parseNdjson(data, size, grade, error);
+    if (ok) {
+        on_row(line, grade);
+    } else {
+        on_error(line, error);
+    }
+}
+
+bool GradeImportParser::parseCsv(const char* data, size_t size, Grade& grade, std::string& error) {
+    std::string fields[FIELD_COUNT];
+    size_t pos = 0;
+    for (size_t i = 0; i < FIELD_COUNT; i++) {
+        if (!readCsvField(data, size, pos, fields[i])) {
+            error = "некорректные кавычки в поле " + std::string(FIELD_NAMES[i]);
+            return false;
+        }
+        bool last = i + 1 == FIELD_COUNT;
+        if (!last && pos == size) {
+            error = "ожидается " + std::to_string(FIELD_COUNT) + " полей";
+            return false;
+        }
+        if (last && pos != size) {
+            error = "лишние поля в строке";
+            return false;
+        }
+        pos++;  // Разделитель
+    }
+    return fromFields(fields, grade, error);
+}
+
+bool GradeImportParser::parseNdjson(const char* data, size_t size, Grade& grade, std::string& error) {
+    std::string fields[FIELD_COUNT];
+    bool present[FIELD_COUNT] = {};
+    JsonLine json(data, size);
+    if (!json.parse(fields, present, error)) {
+        return false;
+    }
+    for (size_t i = 0; i < FIELD_COUNT; i++) {
+        if (!present[i]) {
+            error = "нет поля " + std::string(FIELD_NAMES[i]);
+            return false;
+        }
+    }
+    return fromFields(fields, grade, error);
+}
@@ -0,0 +1,86 @@
+#ifndef GRADE_IMPORT_H
+#define GRADE_IMPORT_H
+
+#include "models.h"
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+// Формат тела запроса /api/admin/grades/import
+enum class ImportFormat {
+    Csv,    // student_id,subject,grade,semester,attendance_percent,assignment_completion,exam_result
+    Ndjson  // По одному JSON-объекту с теми же полями на строку
+};
+
+// Ошибка в строке импорта
+struct ImportError {
+    size_t line = 0;
+    std::string message;
+};
+
+// Результат импорта
+struct ImportReport {
+    static constexpr size_t MAX_REPORTED_ERRORS = 1000;
+
+    size_t rows = 0;                    // Строк данных (без заголовка и пустых)
+    size_t imported = 0;                // Записано в БД (0, если импорт отменен)
+    size_t error_count = 0;             // Всего строк с ошибками
+    std::vector<ImportError> errors;    // Первые MAX_REPORTED_ERRORS из них
+    bool committed = false;
+    std::string failure;                // Причина отмены, не связанная с конкретной строкой
+
+    void addError(size_t line, const std::string& message) {
+        error_count++;
+        if (errors.size() < MAX_REPORTED_ERRORS) {
+            errors.push_back({line, message});
+        }
+    }
+};
+
+// Потоковый разбор и проверка строк импорта оценок.
+// Данные подаются кусками любого размера (как они приходят из сокета);
+// каждая полная строка сразу разбирается и передается on_row или on_error,
+// так что тело запроса целиком в памяти не хранится.
+// Проверяется формат и допустимые значения полей; существование студента
+// проверяет вызывающий код.
+class GradeImportParser {
+public:
+    // Строка прошла проверку (grade.id не заполняется)
+    using RowHandler = std::function<void(size_t line, const Grade& grade)>;
+    // Строка с ошибкой
+    using ErrorHandler = std::function<void(size_t line, const std::string& message)>;
+
+    static constexpr size_t MAX_LINE_BYTES = 64 * 1024;
+
+private:
+    ImportFormat format;
+    RowHandler on_row;
+    ErrorHandler on_error;
+
+    std::string pending;        // Начало строки, конец которой еще не пришел
+    size_t line = 0;            // Номер текущей строки (с 1)
+    bool header_checked = false;
+    bool skipping_long_line = false;
+
+    void processLine(const char* data, size_t size);
+    bool parseCsv(const char* data, size_t size, Grade& grade, std::string& error);
+    bool parseNdjson(const char* data, size_t size, Grade& grade, std::string& error);
+
+public:
+    GradeImportParser(ImportFormat format, RowHandler on_row, ErrorHandler on_error);
+
+    void feed(const char* data, size_t size);
+    // Обработать последнюю строку без перевода строки в конце
+    void finish();
+
+    size_t lines() const { return line; }
+
+    // Формат по имени ("csv", "ndjson") или Content-Type; false, если не распознан
+    static bool parseFormat(const std::string& name, ImportFormat& format);
+
+    // Проверка значений полей (общая для обоих форматов)
+    static bool validate(const Grade& grade, std::string& error);
+};
+
+#endif
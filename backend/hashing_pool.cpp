@@ -0,0 +1,103 @@
+#include "hashing_pool.h"
+#include <utility>
+
+HashingPool::HashingPool(const HashingPoolConfig& config) : config(config) {
+    if (this->config.workers == 0) {
+        this->config.workers = 1;
+    }
+    threads.reserve(this->config.workers);
+    for (size_t i = 0; i < this->config.workers; i++) {
+        threads.emplace_back(&HashingPool::workerLoop, this);
+    }
+}
+
+HashingPool::~HashingPool() {
+    shutdown();
+}
+
+bool HashingPool::run(const std::function<void()>& job) {
+    // Задача живет на стеке вызывающего: он ждет ее завершения под тем же мьютексом
+    Task task;
+    task.job = job;
+    task.enqueued = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    // Одновременно не больше workers хешей считается и max_queued ждет
+    if (shutting_down || busy.load() + tasks.size() >= config.workers + config.max_queued) {
+        rejected++;
+        return false;
+    }
+    tasks.push_back(&task);
+    tasks_cv.notify_one();
+    done_cv.wait(lock, [&task] { return task.done; });
+    lock.unlock();
+
+    if (task.error) {
+        std::rethrow_exception(task.error);
+    }
+    return true;
+}
+
+void HashingPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (shutting_down) {
+            return;
+        }
+        shutting_down = true;
+    }
+    tasks_cv.notify_all();
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+HashingPoolStats HashingPool::stats() {
+    HashingPoolStats s;
+    s.workers = config.workers;
+    s.busy = busy.load();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        s.queued = tasks.size();
+    }
+    s.completed = completed.load();
+    s.rejected = rejected.load();
+    s.wait_time_us = wait_time_us.load();
+    return s;
+}
+
+void HashingPool::workerLoop() {
+    while (true) {
+        Task* task = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            tasks_cv.wait(lock, [this] { return !tasks.empty() || shutting_down; });
+            if (tasks.empty()) {
+                return;     // Остановка, очередь разобрана
+            }
+            task = tasks.front();
+            tasks.pop_front();
+            busy++;
+        }
+        wait_time_us += std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - task->enqueued).count();
+
+        std::exception_ptr error;
+        try {
+            task->job();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task->error = error;
+            task->done = true;
+            busy--;
+        }
+        completed++;
+        done_cv.notify_all();
+    }
+}
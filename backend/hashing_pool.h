@@ -0,0 +1,77 @@
+#ifndef HASHING_POOL_H
+#define HASHING_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <cstdint>
+#include <cstddef>
+
+// Настройки пула хеширования паролей
+struct HashingPoolConfig {
+    size_t workers = 2;         // Потоков, считающих хеши
+    size_t max_queued = 4;      // Хешей, ожидающих свободный поток
+};
+
+// Счетчики пула (снимок на момент вызова)
+struct HashingPoolStats {
+    size_t workers = 0;
+    size_t busy = 0;            // Потоков, занятых хешем
+    size_t queued = 0;          // Хешей в очереди
+    uint64_t completed = 0;     // Всего посчитано
+    uint64_t rejected = 0;      // Отклонено из-за переполненной очереди
+    uint64_t wait_time_us = 0;  // Суммарное ожидание в очереди
+};
+
+// Отдельные потоки для хеширования паролей (scrypt намеренно дорогой по времени и памяти).
+// Поток обработки HTTP ставит хеш в очередь и ждет результат; если очередь заполнена,
+// хеш не считается, и клиент сразу получает 503. Так волна входов занимает не больше
+// workers + max_queued потоков обработки, а остальные продолжают обслуживать чтение
+class HashingPool {
+private:
+    struct Task {
+        std::function<void()> job;
+        std::chrono::steady_clock::time_point enqueued;
+        bool done = false;
+        std::exception_ptr error;
+    };
+
+    HashingPoolConfig config;
+
+    std::deque<Task*> tasks;
+    std::mutex mutex;
+    std::condition_variable tasks_cv;
+    std::condition_variable done_cv;
+    bool shutting_down = false;
+
+    std::vector<std::thread> threads;
+    std::atomic<size_t> busy{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> wait_time_us{0};
+
+    void workerLoop();
+
+public:
+    explicit HashingPool(const HashingPoolConfig& config = HashingPoolConfig());
+    ~HashingPool();
+
+    HashingPool(const HashingPool&) = delete;
+    HashingPool& operator=(const HashingPool&) = delete;
+
+    // Выполнить job в потоке пула и дождаться завершения (исключения job пробрасываются).
+    // false - очередь заполнена или пул остановлен, job не выполнялся
+    bool run(const std::function<void()>& job);
+
+    void shutdown();
+
+    HashingPoolStats stats();
+};
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <string>
+#include <string_view>
+#include "number_format.h"
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+// Потоковая запись JSON в один заранее зарезервированный буфер.
+// Числа форматируются через NumberFormat::write (без временных строк),
+// строки экранируются по таблице. Запятые между элементами расставляются сами.
+class JsonWriter {
+private:
+    static constexpr int MAX_DEPTH = 32;
+
+    std::string out;
+    bool first[MAX_DEPTH];  // В текущем контейнере еще не было элементов
+    int depth = 0;
+    bool after_key = false;
+
+    // Таблица экранирования: 0 - символ пишется как есть, 'u' - как \u00XX,
+    // иначе - символ после обратной косой черты
+    static const char* escapeTable() {
+        static const struct Table {
+            char t[256];
+            Table() : t() {
+                for (int c = 0; c < 0x20; c++) t[c] = 'u';
+                t[(unsigned char)'\b'] = 'b';
+                t[(unsigned char)'\f'] = 'f';
+                t[(unsigned char)'\n'] = 'n';
+                t[(unsigned char)'\r'] = 'r';
+                t[(unsigned char)'\t'] = 't';
+                t[(unsigned char)'"'] = '"';
+                t[(unsigned char)'\\'] = '\\';
+            }
+        } table;
+        return table.t;
+    }
+
+    void separator() {
+        if (after_key) {
+            after_key = false;
+            return;
+        }
+        if (depth > 0 && depth <= MAX_DEPTH) {
+            if (!first[depth - 1]) {
+                out.push_back(',');
+            }
+            first[depth - 1] = false;
+        }
+    }
+
+    void open(char c) {
+        separator();
+        out.push_back(c);
+        if (depth < MAX_DEPTH) {
+            first[depth] = true;
+        }
+        depth++;
+    }
+
+    void close(char c) {
+        depth--;
+        out.push_back(c);
+    }
+
+    void writeEscaped(std::string_view s) {
+        const char* table = escapeTable();
+        out.push_back('"');
+        size_t run = 0;
+        for (size_t i = 0; i < s.size(); i++) {
+            char e = table[(unsigned char)s[i]];
+            if (e == 0) {
+                continue;
+            }
+            out.append(s.data() + run, i - run);
+            run = i + 1;
+            if (e == 'u') {
+                static const char hex[] = "0123456789abcdef";
+                char buf[6] = {'\\', 'u', '0', '0', hex[((unsigned char)s[i]) >> 4], hex[s[i] & 0xF]};
+                out.append(buf, sizeof(buf));
+            } else {
+                char buf[2] = {'\\', e};
+                out.append(buf, sizeof(buf));
+            }
+        }
+        out.append(s.data() + run, s.size() - run);
+        out.push_back('"');
+    }
+
+    template<typename T>
+    void writeNumber(T value) {
+        char buf[NumberFormat::BUFFER_SIZE];
+        out.append(buf, NumberFormat::write(buf, value) - buf);
+    }
+
+public:
+    explicit JsonWriter(size_t reserve = 256) {
+        out.reserve(reserve);
+    }
+
+    JsonWriter& beginObject() { open('{'); return *this; }
+    JsonWriter& endObject() { close('}'); return *this; }
+    JsonWriter& beginArray() { open('['); return *this; }
+    JsonWriter& endArray() { close(']'); return *this; }
+
+    JsonWriter& key(std::string_view name) {
+        separator();
+        writeEscaped(name);
+        out.push_back(':');
+        after_key = true;
+        return *this;
+    }
+
+    JsonWriter& value(std::string_view s) { separator(); writeEscaped(s); return *this; }
+    JsonWriter& value(const char* s) { return value(std::string_view(s)); }
+    JsonWriter& value(const std::string& s) { return value(std::string_view(s)); }
+    JsonWriter& value(bool b) { separator(); out.append(b ? "true" : "false"); return *this; }
+    JsonWriter& value(int v) { separator(); writeNumber(v); return *this; }
+    JsonWriter& value(long v) { separator(); writeNumber(v); return *this; }
+    JsonWriter& value(long long v) { separator(); writeNumber(v); return *this; }
+    JsonWriter& value(unsigned v) { separator(); writeNumber(v); return *this; }
+    JsonWriter& value(unsigned long v) { separator(); writeNumber(v); return *this; }
+    JsonWriter& value(unsigned long long v) { separator(); writeNumber(v); return *this; }
+    JsonWriter& value(double v) {
+        separator();
+        if (std::isfinite(v)) {
+            writeNumber(v);   // Кратчайшее представление, которое читается обратно без потерь
+        } else {
+            out.append("null");
+        }
+        return *this;
+    }
+    JsonWriter& null() { separator(); out.append("null"); return *this; }
+
+    // Пара "ключ: значение"
+    template<typename T>
+    JsonWriter& field(std::string_view name, const T& v) { key(name); return value(v); }
+
+    const std::string& str() const { return out; }
+    std::string take() { return std::move(out); }
+    size_t size() const { return out.size(); }
+
+    // Очистить буфер, сохранив выделенную память (для записи по частям)
+    void clear() {
+        out.clear();
+    }
+};
+
+#endif
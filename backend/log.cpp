@@ -0,0 +1,304 @@
+#include "log.h"
+#include "json_writer.h"
+#include <cstdio>
+#include <ctime>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace Log {
+
+    namespace detail {
+        std::atomic<int> min_level{(int)Level::Info};
+    }
+
+    namespace {
+        const char* const LEVEL_NAMES[] = {"debug", "info", "warn", "error"};
+
+        // Кольцевой буфер потока: пишет только свой поток, читает только поток вывода.
+        // Записи - целые строки, head сдвигается после записи строки целиком,
+        // поэтому читатель никогда не видит половину строки
+        class Ring {
+        private:
+            std::vector<char> data;
+            size_t mask;
+            std::atomic<size_t> head{0};    // Сколько байт записано (позиция писателя)
+            std::atomic<size_t> tail{0};    // Сколько прочитано (позиция читателя)
+
+        public:
+            std::atomic<bool> owner_alive{true};
+
+            explicit Ring(size_t bytes) {
+                size_t size = 1024;
+                while (size < bytes) {
+                    size <<= 1;
+                }
+                data.resize(size);
+                mask = size - 1;
+            }
+
+            // Записать строку и перевод строки; false - не хватает места
+            bool push(std::string_view line) {
+                size_t size = line.size() + 1;
+                size_t h = head.load(std::memory_order_relaxed);
+                size_t t = tail.load(std::memory_order_acquire);
+                if (size > data.size() - (h - t)) {
+                    return false;
+                }
+                size_t offset = h & mask;
+                size_t first = std::min(line.size(), data.size() - offset);
+                std::copy(line.begin(), line.begin() + first, data.begin() + offset);
+                std::copy(line.begin() + first, line.end(), data.begin());
+                data[(h + line.size()) & mask] = '\n';
+                head.store(h + size, std::memory_order_release);
+                return true;
+            }
+
+            // Дописать в out все, что накоплено
+            void drain(std::string& out) {
+                size_t t = tail.load(std::memory_order_relaxed);
+                size_t h = head.load(std::memory_order_acquire);
+                if (h == t) {
+                    return;
+                }
+                size_t offset = t & mask;
+                size_t size = h - t;
+                size_t first = std::min(size, data.size() - offset);
+                out.append(data.data() + offset, first);
+                out.append(data.data(), size - first);
+                tail.store(h, std::memory_order_release);
+            }
+
+            bool empty() const {
+                return head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed);
+            }
+        };
+
+        Config config;
+        std::atomic<bool> running{false};
+        std::atomic<uint64_t> written{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> suppressed_total{0};
+
+        std::mutex registry_mutex;
+        std::vector<std::shared_ptr<Ring>> rings;
+
+        std::mutex flusher_mutex;
+        std::condition_variable flusher_cv;
+        std::thread flusher;
+        bool stopping = false;
+
+        // Синхронный вывод (до start и после stop)
+        std::mutex direct_mutex;
+
+        // Буфер и форматирование записей текущего потока
+        struct ThreadLog {
+            std::shared_ptr<Ring> ring;
+            JsonWriter json{512};
+            int64_t cached_second = -1;
+            char second_text[24] = {};     // "2026-01-31T12:34:56" для cached_second
+
+            ~ThreadLog() {
+                if (ring) {
+                    ring->owner_alive = false;  // Поток вывода удалит буфер, когда выведет остаток
+                }
+            }
+
+            Ring& localRing() {
+                if (!ring) {
+                    ring = std::make_shared<Ring>(config.buffer_bytes);
+                    std::lock_guard<std::mutex> lock(registry_mutex);
+                    rings.push_back(ring);
+                }
+                return *ring;
+            }
+
+            // Время в UTC с миллисекундами; дата и время форматируются раз в секунду
+            void timestamp(char* out) {
+                auto now = std::chrono::system_clock::now().time_since_epoch();
+                int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+                int64_t second = ms / 1000;
+                if (second != cached_second) {
+                    time_t t = (time_t)second;
+                    std::tm tm{};
+                    gmtime_r(&t, &tm);
+                    std::strftime(second_text, sizeof(second_text), "%Y-%m-%dT%H:%M:%S", &tm);
+                    cached_second = second;
+                }
+                std::snprintf(out, 32, "%s.%03dZ", second_text, (int)(ms % 1000));
+            }
+        };
+
+        thread_local ThreadLog thread_log;
+
+        void flushAll(std::string& out) {
+            out.clear();
+            {
+                std::lock_guard<std::mutex> lock(registry_mutex);
+                for (auto it = rings.begin(); it != rings.end();) {
+                    (*it)->drain(out);
+                    // Поток завершился и все его записи выведены
+                    if (!(*it)->owner_alive.load() && (*it)->empty()) {
+                        it = rings.erase(it);
+                    } else {
+                        ++it;
+                    }
+                }
+            }
+            if (!out.empty()) {
+                written += (uint64_t)std::count(out.begin(), out.end(), '\n');
+                std::fwrite(out.data(), 1, out.size(), stdout);
+                std::fflush(stdout);
+            }
+        }
+
+        void flusherLoop() {
+            std::string out;
+            out.reserve(64 * 1024);
+            uint64_t reported_dropped = 0;
+            std::unique_lock<std::mutex> lock(flusher_mutex);
+            while (!stopping) {
+                flusher_cv.wait_for(lock, std::chrono::milliseconds(config.flush_interval_ms));
+                lock.unlock();
+                flushAll(out);
+                uint64_t now_dropped = dropped.load();
+                if (now_dropped != reported_dropped) {
+                    LOG_WARN("Log: records dropped, thread buffer full",
+                             {{"dropped", now_dropped - reported_dropped}});
+                    reported_dropped = now_dropped;
+                }
+                lock.lock();
+            }
+        }
+    }
+
+    namespace {
+        // Остановить поток вывода при завершении программы (объявлен после
+        // буферов, поэтому разрушается раньше них)
+        struct StopAtExit {
+            ~StopAtExit() { stop(); }
+        } stop_at_exit;
+    }
+
+    bool Site::allow(unsigned limit, uint64_t& suppressed_before) {
+        suppressed_before = 0;
+        if (limit == 0) {
+            return true;
+        }
+        uint64_t second = (uint64_t)std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        uint64_t current = window.load(std::memory_order_relaxed);
+        if (current != second && window.compare_exchange_strong(current, second, std::memory_order_relaxed)) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        if (count.fetch_add(1, std::memory_order_relaxed) < limit) {
+            if (suppressed.load(std::memory_order_relaxed) != 0) {
+                suppressed_before = suppressed.exchange(0, std::memory_order_relaxed);
+            }
+            return true;
+        }
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        suppressed_total.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void start(const Config& new_config) {
+        stop();
+        config = new_config;
+        setLevel(config.level);
+        stopping = false;
+        running = true;
+        flusher = std::thread(flusherLoop);
+    }
+
+    void stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(flusher_mutex);
+            stopping = true;
+        }
+        flusher_cv.notify_one();
+        flusher.join();
+        std::string out;
+        flushAll(out);
+    }
+
+    void setLevel(Level level) {
+        detail::min_level = (int)level;
+    }
+
+    bool parseLevel(const std::string& name, Level& level) {
+        for (int i = 0; i < 4; i++) {
+            if (name == LEVEL_NAMES[i]) {
+                level = (Level)i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void write(Level level, Site& site, std::string_view message, std::initializer_list<Field> fields) {
+        uint64_t suppressed_before = 0;
+        if (!site.allow(config.rate_limit, suppressed_before)) {
+            return;
+        }
+
+        ThreadLog& local = thread_log;
+        char ts[32];
+        local.timestamp(ts);
+
+        JsonWriter& json = local.json;
+        json.clear();
+        json.beginObject()
+            .field("ts", ts)
+            .field("level", LEVEL_NAMES[(int)level])
+            .field("msg", message);
+        for (const Field& f : fields) {
+            json.key(f.key);
+            switch (f.type) {
+                case Field::Type::String: json.value(f.text); break;
+                case Field::Type::Int: json.value((long long)f.i); break;
+                case Field::Type::Uint: json.value((unsigned long long)f.u); break;
+                case Field::Type::Double: json.value(f.d); break;
+                case Field::Type::Bool: json.value(f.b); break;
+            }
+        }
+        if (suppressed_before > 0) {
+            json.field("suppressed", (unsigned long long)suppressed_before);
+        }
+        json.endObject();
+
+        if (!running.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(direct_mutex);
+            std::fwrite(json.str().data(), 1, json.size(), stdout);
+            std::fputc('\n', stdout);
+            std::fflush(stdout);
+            written++;
+        } else if (!local.localRing().push(json.str())) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            // stop() мог выключить running и сделать последний вывод между проверкой выше
+            // и push - тогда запись осталась бы в буфере. Барьер упорядочивает push и
+            // повторную проверку: либо stop() увидит запись, либо поток выведет ее сам
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!running.load(std::memory_order_relaxed)) {
+                std::string out;
+                flushAll(out);
+            }
+        }
+    }
+
+    Stats stats() {
+        Stats result;
+        result.written = written.load();
+        result.dropped = dropped.load();
+        result.suppressed = suppressed_total.load();
+        return result;
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <string>
+#include <string_view>
+#include <initializer_list>
+#include <type_traits>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Асинхронный структурированный журнал: каждая запись - одна строка JSON
+// {"ts":"...","level":"info","msg":"...", поля...} в stdout.
+// Поток, который пишет запись, только форматирует ее в свой кольцевой буфер
+// (один писатель, один читатель - без блокировок); отдельный поток раз в
+// flush_interval_ms собирает буферы всех потоков и выводит их одной записью.
+// Если буфер потока заполнен, запись отбрасывается (счетчик dropped), поток не ждет.
+// Записи разных потоков могут выводиться не по порядку - сортировать по ts.
+//
+// Использование: LOG_INFO("User logged in", {{"user", username}, {"role", role}});
+// LOG_DEBUG в сборке с NDEBUG (make без DEBUG=1) не компилируется вовсе, аргументы
+// не вычисляются. Каждое место вызова пишет не больше rate_limit записей в секунду,
+// число пропущенных добавляется к следующей записи полем "suppressed"
+namespace Log {
+    enum class Level {
+        Debug = 0,
+        Info,
+        Warn,
+        Error
+    };
+
+    struct Config {
+        Level level = Level::Info;
+        size_t buffer_bytes = 64 * 1024;    // Кольцевой буфер каждого потока (округляется до степени двойки)
+        unsigned rate_limit = 100;          // Записей в секунду с одного места вызова (0 - без ограничения)
+        unsigned flush_interval_ms = 50;
+    };
+
+    struct Stats {
+        uint64_t written = 0;       // Выведено записей
+        uint64_t dropped = 0;       // Отброшено: буфер потока был заполнен
+        uint64_t suppressed = 0;    // Пропущено ограничением частоты
+    };
+
+    // Поле записи: ключ и строка, число или bool. Строки не копируются -
+    // поле живет до конца выражения с LOG_*
+    class Field {
+    public:
+        enum class Type { String, Int, Uint, Double, Bool };
+
+        std::string_view key;
+        Type type;
+        std::string_view text;
+        union {
+            int64_t i;
+            uint64_t u;
+            double d;
+            bool b;
+        };
+
+        Field(std::string_view key, std::string_view value) : key(key), type(Type::String), text(value), u(0) {}
+        Field(std::string_view key, const char* value) : Field(key, std::string_view(value ? value : "")) {}
+        Field(std::string_view key, const std::string& value) : Field(key, std::string_view(value)) {}
+        Field(std::string_view key, bool value) : key(key), type(Type::Bool), b(value) {}
+        Field(std::string_view key, double value) : key(key), type(Type::Double), d(value) {}
+
+        template<typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+        Field(std::string_view key, T value) : key(key), type(std::is_signed<T>::value ? Type::Int : Type::Uint) {
+            if (std::is_signed<T>::value) {
+                i = (int64_t)value;
+            } else {
+                u = (uint64_t)value;
+            }
+        }
+    };
+
+    // Состояние места вызова для ограничения частоты (static в макросе LOG_*)
+    class Site {
+    private:
+        std::atomic<uint64_t> window{0};        // Секунда, к которой относится count
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint64_t> suppressed{0};
+
+    public:
+        // Можно ли писать запись; suppressed_before - сколько пропущено с прошлой записи
+        bool allow(unsigned limit, uint64_t& suppressed_before);
+    };
+
+    namespace detail {
+        extern std::atomic<int> min_level;
+    }
+
+    // Запустить поток вывода; до start и после stop записи выводятся сразу (синхронно)
+    void start(const Config& config);
+    // Вывести все накопленное и остановить поток вывода
+    void stop();
+
+    inline bool enabled(Level level) {
+        return (int)level >= detail::min_level.load(std::memory_order_relaxed);
+    }
+
+    void setLevel(Level level);
+    // "debug", "info", "warn", "error"; false - неизвестный уровень
+    bool parseLevel(const std::string& name, Level& level);
+
+    void write(Level level, Site& site, std::string_view message, std::initializer_list<Field> fields = {});
+
+    Stats stats();
+}
+
+#define LOG_AT(level, ...) \
+    do { \
+        if (::Log::enabled(level)) { \
+            static ::Log::Site log_site_; \
+            ::Log::write(level, log_site_, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#ifdef NDEBUG
+#define LOG_DEBUG(...) do {} while (0)
+#else
+#define LOG_DEBUG(...) LOG_AT(::Log::Level::Debug, __VA_ARGS__)
+#endif
+#define LOG_INFO(...) LOG_AT(::Log::Level::Info, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(::Log::Level::Warn, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(::Log::Level::Error, __VA_ARGS__)
+
+#endif
@@ -0,0 +1,303 @@
+#include "metrics.h"
+#include "queries.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <array>
+#include <stdexcept>
+
+namespace Metrics {
+
+    namespace {
+        // Границы корзин гистограмм задержки, нс (0.1 мс .. 10 с)
+        const uint64_t BUCKETS_NS[] = {
+            100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000, 25000000,
+            50000000, 100000000, 250000000, 500000000, 1000000000, 2500000000, 5000000000, 10000000000
+        };
+        const size_t BUCKET_COUNT = sizeof(BUCKETS_NS) / sizeof(BUCKETS_NS[0]);
+        const char* const BUCKET_LABELS[] = {
+            "0.0001", "0.00025", "0.0005", "0.001", "0.0025", "0.005", "0.01", "0.025",
+            "0.05", "0.1", "0.25", "0.5", "1", "2.5", "5", "10"
+        };
+
+        // Классы кодов ответа: 1xx..5xx
+        const size_t STATUS_CLASSES = 5;
+
+        // Счетчик с одним писателем (своим потоком): увеличение без lock-префикса,
+        // при этом чтение из потока /metrics не является гонкой данных
+        struct Counter {
+            std::atomic<uint64_t> value{0};
+
+            void add(uint64_t n) { value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+            uint64_t get() const { return value.load(std::memory_order_relaxed); }
+        };
+
+        struct Histogram {
+            Counter buckets[BUCKET_COUNT + 1];      // Последняя - больше всех границ (+Inf)
+            Counter sum_ns;
+
+            void observe(uint64_t ns) {
+                size_t i = 0;
+                while (i < BUCKET_COUNT && ns > BUCKETS_NS[i]) {
+                    i++;
+                }
+                buckets[i].add(1);
+                sum_ns.add(ns);
+            }
+        };
+
+        struct RouteCounters {
+            Counter status[STATUS_CLASSES];
+            Histogram latency;
+        };
+
+        struct QueryCounters {
+            Histogram latency;
+            Counter errors;
+        };
+
+        struct Shard {
+            RouteCounters routes[MAX_ROUTES];
+            QueryCounters queries[Queries::COUNT];
+            Histogram connect;
+            Counter connect_errors;
+            Counter response_bytes;
+        };
+
+        // Суммы по всем потокам (собираются при запросе /metrics)
+        struct HistogramTotals {
+            uint64_t buckets[BUCKET_COUNT + 1] = {};
+            uint64_t sum_ns = 0;
+
+            void add(const Histogram& h) {
+                for (size_t i = 0; i <= BUCKET_COUNT; i++) {
+                    buckets[i] += h.buckets[i].get();
+                }
+                sum_ns += h.sum_ns.get();
+            }
+
+            uint64_t count() const {
+                uint64_t total = 0;
+                for (uint64_t b : buckets) {
+                    total += b;
+                }
+                return total;
+            }
+        };
+
+        std::mutex registry_mutex;
+        std::vector<std::unique_ptr<Shard>> shards;
+        std::array<std::string, MAX_ROUTES> route_names;
+        std::atomic<size_t> route_count{0};
+
+        Shard& localShard() {
+            thread_local Shard* shard = nullptr;
+            if (!shard) {
+                auto created = std::make_unique<Shard>();
+                shard = created.get();
+                std::lock_guard<std::mutex> lock(registry_mutex);
+                shards.push_back(std::move(created));
+            }
+            return *shard;
+        }
+
+        // Значение метки с экранированием по правилам формата Prometheus
+        void appendLabel(std::string& out, const std::string& value) {
+            for (char c : value) {
+                if (c == '\\' || c == '"') {
+                    out += '\\';
+                    out += c;
+                } else if (c == '\n') {
+                    out += "\\n";
+                } else {
+                    out += c;
+                }
+            }
+        }
+
+        void appendSeconds(std::string& out, uint64_t ns) {
+            out += std::to_string(ns / 1000000000);
+            std::string fraction = std::to_string(ns % 1000000000);
+            out += '.';
+            out.append(9 - fraction.size(), '0');
+            out += fraction;
+        }
+
+        void writeHeader(std::string& out, const char* name, const char* type, const char* help) {
+            out += "# HELP ";
+            out += name;
+            out += ' ';
+            out += help;
+            out += "\n# TYPE ";
+            out += name;
+            out += ' ';
+            out += type;
+            out += '\n';
+        }
+
+        // Строки гистограммы name с меткой label="value" (без метки, если label пустая)
+        void writeHistogram(std::string& out, const char* name, const char* label, const std::string& value,
+                            const HistogramTotals& h) {
+            std::string labels;
+            if (*label) {
+                labels += label;
+                labels += "=\"";
+                appendLabel(labels, value);
+                labels += '"';
+            }
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i <= BUCKET_COUNT; i++) {
+                cumulative += h.buckets[i];
+                out += name;
+                out += "_bucket{";
+                if (!labels.empty()) {
+                    out += labels;
+                    out += ',';
+                }
+                out += "le=\"";
+                out += i < BUCKET_COUNT ? BUCKET_LABELS[i] : "+Inf";
+                out += "\"} ";
+                out += std::to_string(cumulative);
+                out += '\n';
+            }
+            std::string suffix = labels.empty() ? " " : "{" + labels + "} ";
+            out += name;
+            out += "_sum";
+            out += suffix;
+            appendSeconds(out, h.sum_ns);
+            out += '\n';
+            out += name;
+            out += "_count";
+            out += suffix;
+            out += std::to_string(cumulative);
+            out += '\n';
+        }
+    }
+
+    size_t registerRoute(const std::string& name) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        size_t index = route_count.load();
+        if (index >= MAX_ROUTES) {
+            throw std::length_error("Metrics: слишком много маршрутов (MAX_ROUTES)");
+        }
+        route_names[index] = name;
+        route_count = index + 1;
+        return index;
+    }
+
+    void recordRequest(size_t route, int status, uint64_t duration_ns) {
+        RouteCounters& counters = localShard().routes[route];
+        size_t status_class = status >= 100 && status < 600 ? (size_t)(status / 100 - 1) : STATUS_CLASSES - 1;
+        counters.status[status_class].add(1);
+        counters.latency.observe(duration_ns);
+    }
+
+    void recordQuery(size_t query, uint64_t duration_ns, bool failed) {
+        QueryCounters& counters = localShard().queries[query];
+        counters.latency.observe(duration_ns);
+        if (failed) {
+            counters.errors.add(1);
+        }
+    }
+
+    void recordConnect(uint64_t duration_ns, bool failed) {
+        Shard& shard = localShard();
+        shard.connect.observe(duration_ns);
+        if (failed) {
+            shard.connect_errors.add(1);
+        }
+    }
+
+    void addResponseBytes(size_t bytes) {
+        localShard().response_bytes.add(bytes);
+    }
+
+    uint64_t now() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void writeSample(std::string& out, const char* name, const char* type, const char* help, uint64_t value) {
+        writeHeader(out, name, type, help);
+        out += name;
+        out += ' ';
+        out += std::to_string(value);
+        out += '\n';
+    }
+
+    void render(std::string& out) {
+        size_t routes = route_count.load();
+        std::vector<std::array<uint64_t, STATUS_CLASSES>> status(routes);
+        std::vector<HistogramTotals> route_latency(routes);
+        std::vector<HistogramTotals> query_latency(Queries::COUNT);
+        std::vector<uint64_t> query_errors(Queries::COUNT);
+        HistogramTotals connect;
+        uint64_t connect_errors = 0;
+        uint64_t response_bytes = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            for (const auto& shard : shards) {
+                for (size_t r = 0; r < routes; r++) {
+                    for (size_t c = 0; c < STATUS_CLASSES; c++) {
+                        status[r][c] += shard->routes[r].status[c].get();
+                    }
+                    route_latency[r].add(shard->routes[r].latency);
+                }
+                for (size_t q = 0; q < Queries::COUNT; q++) {
+                    query_latency[q].add(shard->queries[q].latency);
+                    query_errors[q] += shard->queries[q].errors.get();
+                }
+                connect.add(shard->connect);
+                connect_errors += shard->connect_errors.get();
+                response_bytes += shard->response_bytes.get();
+            }
+        }
+
+        writeHeader(out, "http_requests_total", "counter", "Запросы по маршрутам и классам кода ответа");
+        for (size_t r = 0; r < routes; r++) {
+            for (size_t c = 0; c < STATUS_CLASSES; c++) {
+                if (status[r][c] == 0) {
+                    continue;
+                }
+                out += "http_requests_total{route=\"";
+                appendLabel(out, route_names[r]);
+                out += "\",code=\"";
+                out += std::to_string(c + 1);
+                out += "xx\"} ";
+                out += std::to_string(status[r][c]);
+                out += '\n';
+            }
+        }
+
+        writeHeader(out, "http_request_duration_seconds", "histogram", "Время обработки запроса");
+        for (size_t r = 0; r < routes; r++) {
+            writeHistogram(out, "http_request_duration_seconds", "route", route_names[r], route_latency[r]);
+        }
+
+        writeHeader(out, "db_query_duration_seconds", "histogram", "Время выполнения подготовленных запросов");
+        for (size_t q = 0; q < Queries::COUNT; q++) {
+            if (query_latency[q].count() > 0) {
+                writeHistogram(out, "db_query_duration_seconds", "query", Queries::NAMES[q], query_latency[q]);
+            }
+        }
+
+        writeHeader(out, "db_query_errors_total", "counter", "Запросы, завершившиеся ошибкой");
+        for (size_t q = 0; q < Queries::COUNT; q++) {
+            if (query_errors[q] > 0) {
+                out += "db_query_errors_total{query=\"";
+                out += Queries::NAMES[q];
+                out += "\"} ";
+                out += std::to_string(query_errors[q]);
+                out += '\n';
+            }
+        }
+
+        writeHeader(out, "db_connect_duration_seconds", "histogram", "Открытие соединения с БД и подготовка запросов");
+        writeHistogram(out, "db_connect_duration_seconds", "", "", connect);
+        writeSample(out, "db_connect_errors_total", "counter", "Неудачные попытки открыть соединение", connect_errors);
+        writeSample(out, "http_response_bytes_total", "counter", "Байт тела ответов до сжатия", response_bytes);
+    }
+}
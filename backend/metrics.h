@@ -0,0 +1,43 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Метрики сервера в формате Prometheus (/metrics).
+// Каждый поток пишет в свой набор счетчиков (без блокировок и без атомарных
+// read-modify-write: у счетчика один писатель), при запросе /metrics наборы всех
+// потоков суммируются. Запись одного запроса - два чтения часов и несколько
+// сложений в памяти своего потока.
+// Наборы потоков не освобождаются: потоки сервера (обработка HTTP, пул хеширования,
+// групповой коммит) создаются при запуске и живут до остановки
+namespace Metrics {
+    const size_t MAX_ROUTES = 64;
+
+    // Зарегистрировать маршрут (при запуске, до обработки запросов); индекс для recordRequest
+    size_t registerRoute(const std::string& name);
+
+    // Запрос к маршруту: код ответа и время обработчика (потоковые ответы - до начала отправки тела)
+    void recordRequest(size_t route, int status, uint64_t duration_ns);
+
+    // Выполнение подготовленного запроса Queries::Id(query); failed - запрос бросил исключение
+    void recordQuery(size_t query, uint64_t duration_ns, bool failed);
+
+    // Открытие соединения с БД (вместе с подготовкой запросов)
+    void recordConnect(uint64_t duration_ns, bool failed);
+
+    // Байт тела ответов до сжатия (JSON, CSV, выгрузки)
+    void addResponseBytes(size_t bytes);
+
+    // Текущее время для замеров, нс
+    uint64_t now();
+
+    // Все метрики в текстовом формате Prometheus
+    void render(std::string& out);
+
+    // Одна метрика без меток (для счетчиков других модулей: пул, очереди, сжатие)
+    void writeSample(std::string& out, const char* name, const char* type, const char* help, uint64_t value);
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef MODELS_H
+#define MODELS_H
+
+#include <string>
+
+struct Student {
+    int id;
+    std::string name;
+    std::string surname;
+    std::string group_name;
+};
+
+struct Grade {
+    int id;
+    int student_id;
+    std::string subject;
+    int grade;
+    int semester;
+    double attendance_percent;
+    double assignment_completion;
+    int exam_result;
+};
+
+struct User {
+    int id;
+    std::string username;
+    std::string email;
+    std::string role;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef NUMBER_FORMAT_H
+#define NUMBER_FORMAT_H
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <cstddef>
+#include <type_traits>
+
+// Запись и разбор дробных чисел без временных строк (JsonWriter, импорт и выгрузка оценок).
+// std::to_chars/from_chars для double есть не везде: libstdc++ - с GCC 11 (тогда определен
+// __cpp_lib_to_chars), в libc++ Apple - только при сборке под macOS 13.3+ (from_chars еще позже).
+// Без них кратчайшая запись, которая читается обратно тем же числом, подбирается
+// через snprintf с точностью 15..17 знаков, а разбор идет через strtod
+// (сервер не меняет локаль, точка остается точкой)
+namespace NumberFormat {
+    constexpr size_t BUFFER_SIZE = 32;
+
+    // Записать value в buf (не меньше BUFFER_SIZE байт); возвращает конец записи
+    template<typename T>
+    char* write(char* buf, T value) {
+        if constexpr (std::is_floating_point_v<T>) {
+#if defined(__cpp_lib_to_chars)
+            return std::to_chars(buf, buf + BUFFER_SIZE, value).ptr;
+#else
+            int length = 0;
+            for (int precision = 15; precision <= 17; precision++) {
+                length = std::snprintf(buf, BUFFER_SIZE, "%.*g", precision, (double)value);
+                if (std::strtod(buf, nullptr) == (double)value) {
+                    break;
+                }
+            }
+            return buf + length;
+#endif
+        } else {
+            return std::to_chars(buf, buf + BUFFER_SIZE, value).ptr;
+        }
+    }
+
+    // Разобрать весь диапазон [first, last) как число в обычной или экспоненциальной записи
+    // (как std::from_chars: без пробелов, '+' и шестнадцатеричной записи)
+    inline bool read(const char* first, const char* last, double& out) {
+        if (first == last) {
+            return false;
+        }
+#if defined(__cpp_lib_to_chars)
+        auto result = std::from_chars(first, last, out);
+        return result.ec == std::errc() && result.ptr == last;
+#else
+        char buf[64];
+        size_t size = last - first;
+        if (size >= sizeof(buf)) {
+            return false;
+        }
+        for (const char* p = first; p != last; p++) {
+            if (!((*p >= '0' && *p <= '9') || *p == '.' || *p == '-' || *p == 'e' || *p == 'E' ||
+                  (p != first && *p == '+'))) {
+                return false;
+            }
+        }
+        std::memcpy(buf, first, size);
+        buf[size] = '\0';
+        char* end = nullptr;
+        errno = 0;
+        out = std::strtod(buf, &end);
+        return end == buf + size && errno != ERANGE;
+#endif
+    }
+}
+
+#endif // NUMBER_FORMAT_H
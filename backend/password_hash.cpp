@@ -1,80 +1,151 @@
 #include "password_hash.h"
+#include <openssl/evp.h>
 #include <openssl/sha.h>
 #include <openssl/rand.h>
-#include <sstream>
-#include <iomanip>
+#include <openssl/crypto.h>
 #include <string>
-#include <cstring>
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
 
 namespace PasswordHash {
     
-    // Преобразование бинарных данных в hex строку
     std::string toHex(const unsigned char* data, size_t length) {
-        std::stringstream ss;
+        static const char digits[] = "0123456789abcdef";
+        std::string out(length * 2, '0');
         for (size_t i = 0; i < length; i++) {
-            ss << std::hex << std::setw(2) << std::setfill('0') << (int)data[i];
+            out[2 * i] = digits[data[i] >> 4];
+            out[2 * i + 1] = digits[data[i] & 0xF];
         }
-        return ss.str();
+        return out;
+    }
+    
+    namespace {
+        const char SCRYPT_PREFIX[] = "scrypt$";
+        const size_t KEY_BYTES = 32;
+        
+        // Задаются один раз при запуске, дальше только читаются
+        Params current;
+        
+        bool equalConstantTime(const std::string& a, const std::string& b) {
+            return a.size() == b.size() && CRYPTO_memcmp(a.data(), b.data(), a.size()) == 0;
+        }
+        
+        // Предел памяти с запасом: по умолчанию OpenSSL ограничивает scrypt 32 МБ
+        uint64_t maxMemory(const Params& params) {
+            return 256 * params.n * params.r * params.p;
+        }
+        
+        // Пустая строка, если OpenSSL отверг параметры или не хватило памяти
+        std::string scrypt(const std::string& password, const std::string& salt, const Params& params) {
+            unsigned char key[KEY_BYTES];
+            uint64_t max_memory = maxMemory(params);
+            if (EVP_PBE_scrypt(password.data(), password.size(),
+                               reinterpret_cast<const unsigned char*>(salt.data()), salt.size(),
+                               params.n, params.r, params.p, max_memory, key, sizeof(key)) != 1) {
+                return "";
+            }
+            return toHex(key, sizeof(key));
+        }
+        
+        // Разбор "scrypt$n$r$p$salt$hash"; false, если формат другой
+        bool parseScrypt(const std::string& stored, Params& params, std::string& salt, std::string& hash) {
+            if (stored.rfind(SCRYPT_PREFIX, 0) != 0) {
+                return false;
+            }
+            std::vector<std::string> parts;
+            size_t pos = sizeof(SCRYPT_PREFIX) - 1;
+            while (true) {
+                size_t end = stored.find('$', pos);
+                parts.push_back(stored.substr(pos, end == std::string::npos ? std::string::npos : end - pos));
+                if (end == std::string::npos) {
+                    break;
+                }
+                pos = end + 1;
+            }
+            if (parts.size() != 5) {
+                return false;
+            }
+            params.n = std::strtoull(parts[0].c_str(), nullptr, 10);
+            params.r = std::strtoull(parts[1].c_str(), nullptr, 10);
+            params.p = std::strtoull(parts[2].c_str(), nullptr, 10);
+            salt = parts[3];
+            hash = parts[4];
+            return params.n > 1 && params.r > 0 && params.p > 0 && !salt.empty() && !hash.empty();
+        }
+    }
+    
+    void setParams(const Params& params) {
+        // n - степень двойки больше 1; остальное (пределы OpenSSL, хватит ли памяти)
+        // проверяет пробный хеш - при запуске, а не при первой регистрации
+        bool valid = params.n > 1 && (params.n & (params.n - 1)) == 0 && params.r > 0 && params.p > 0 &&
+                     !scrypt("", "salt", params).empty();
+        if (!valid) {
+            throw std::invalid_argument("scrypt: недопустимые параметры n=" + std::to_string(params.n) +
+                                        " r=" + std::to_string(params.r) + " p=" + std::to_string(params.p));
+        }
+        current = params;
+    }
+    
+    Params getParams() {
+        return current;
     }
     
     // Генерация случайной соли
     std::string generateSalt() {
         unsigned char salt[16];
         if (RAND_bytes(salt, sizeof(salt)) != 1) {
-            // Если RAND_bytes не работает, используем простую соль
-            std::string simpleSalt = "default_salt_2024";
-            return simpleSalt;
+            // Предсказуемая соль хуже отказа: пароль просто не сохраняется
+            throw std::runtime_error("RAND_bytes: не удалось получить случайную соль");
         }
         return toHex(salt, sizeof(salt));
     }
     
-    // Хеширование пароля с солью (SHA-256)
+    // Хеширование пароля с солью (scrypt)
     std::string hashPassword(const std::string& password) {
-        // Генерируем соль
+        Params params = current;
         std::string salt = generateSalt();
-        
-        // Объединяем пароль и соль
-        std::string saltedPassword = password + salt;
-        
-        // Вычисляем SHA-256 хеш
-        unsigned char hash[SHA256_DIGEST_LENGTH];
-        SHA256_CTX sha256;
-        SHA256_Init(&sha256);
-        SHA256_Update(&sha256, saltedPassword.c_str(), saltedPassword.length());
-        SHA256_Final(hash, &sha256);
-        
-        // Преобразуем хеш в hex строку
-        std::string hashHex = toHex(hash, SHA256_DIGEST_LENGTH);
-        
-        // Возвращаем соль и хеш в формате: salt:hash
-        return salt + ":" + hashHex;
+        std::string hash = scrypt(password, salt, params);
+        if (hash.empty()) {
+            throw std::runtime_error("EVP_PBE_scrypt: не удалось вычислить хеш");
+        }
+        return SCRYPT_PREFIX + std::to_string(params.n) + "$" + std::to_string(params.r) + "$" +
+               std::to_string(params.p) + "$" + salt + "$" + hash;
     }
     
     // Проверка пароля (сравнение с хешем из БД)
     bool verifyPassword(const std::string& password, const std::string& storedHash) {
-        // Парсим сохраненный хеш (формат: salt:hash)
+        Params params;
+        std::string salt;
+        std::string storedHashValue;
+        if (parseScrypt(storedHash, params, salt, storedHashValue)) {
+            std::string computed = scrypt(password, salt, params);
+            return !computed.empty() && equalConstantTime(computed, storedHashValue);
+        }
+        
+        // Старый формат: salt:sha256(password + salt)
         size_t colonPos = storedHash.find(':');
         if (colonPos == std::string::npos) {
             // Старый формат без хеширования (для обратной совместимости)
-            return password == storedHash;
+            return equalConstantTime(password, storedHash);
         }
         
-        std::string salt = storedHash.substr(0, colonPos);
-        std::string storedHashValue = storedHash.substr(colonPos + 1);
+        salt = storedHash.substr(0, colonPos);
+        storedHashValue = storedHash.substr(colonPos + 1);
         
-        // Вычисляем хеш введенного пароля с той же солью
         std::string saltedPassword = password + salt;
-        
         unsigned char hash[SHA256_DIGEST_LENGTH];
-        SHA256_CTX sha256;
-        SHA256_Init(&sha256);
-        SHA256_Update(&sha256, saltedPassword.c_str(), saltedPassword.length());
-        SHA256_Final(hash, &sha256);
-        
-        std::string computedHash = toHex(hash, SHA256_DIGEST_LENGTH);
-        
-        // Сравниваем хеши
-        return computedHash == storedHashValue;
+        SHA256(reinterpret_cast<const unsigned char*>(saltedPassword.data()), saltedPassword.size(), hash);
+        return equalConstantTime(toHex(hash, SHA256_DIGEST_LENGTH), storedHashValue);
+    }
+    
+    bool needsRehash(const std::string& storedHash) {
+        Params params;
+        std::string salt;
+        std::string hash;
+        if (!parseScrypt(storedHash, params, salt, hash)) {
+            return true;
+        }
+        return params.n < current.n || params.r < current.r || params.p < current.p;
     }
 }
-
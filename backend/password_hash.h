@@ -2,17 +2,39 @@
 #define PASSWORD_HASH_H
 
 #include <string>
+#include <cstdint>
+#include <cstddef>
 
 namespace PasswordHash {
-    // Генерация хеша пароля с солью
+    // Параметры scrypt для новых хешей. Память на один хеш - около 128 * n * r байт
+    // (16 МБ по умолчанию), время растет пропорционально n
+    struct Params {
+        uint64_t n = 16384;     // Степень двойки
+        uint64_t r = 8;
+        uint64_t p = 1;
+    };
+    
+    // Задать параметры при запуске (до первого хеширования).
+    // Бросает std::invalid_argument, если OpenSSL не примет такие параметры
+    void setParams(const Params& params);
+    Params getParams();
+    
+    // Генерация хеша пароля с солью: "scrypt$<n>$<r>$<p>$<соль hex>$<хеш hex>".
+    // Бросает std::runtime_error, если не удалось получить соль или посчитать хеш
     std::string hashPassword(const std::string& password);
     
-    // Проверка пароля (сравнение с хешем из БД)
+    // Проверка пароля (сравнение с хешем из БД). Понимает и старый формат "соль:sha256"
     bool verifyPassword(const std::string& password, const std::string& hash);
     
-    // Генерация случайной соли
+    // Хеш в старом формате или с параметрами слабее текущих - его нужно пересчитать
+    // (после успешного входа, пока известен пароль)
+    bool needsRehash(const std::string& hash);
+    
+    // Генерация случайной соли (std::runtime_error, если генератор OpenSSL недоступен)
     std::string generateSalt();
+    
+    // Преобразование бинарных данных в hex строку (строчные буквы)
+    std::string toHex(const unsigned char* data, size_t length);
 }
 
 #endif
-
@@ -0,0 +1,37 @@
+#ifndef PERMISSIONS_H
+#define PERMISSIONS_H
+
+#include <string>
+#include <cstdint>
+
+// Права пользователя в виде битовой маски. Маска вычисляется по роли один раз
+// при входе и хранится в сессии, поэтому проверка доступа в обработчике -
+// одна операция с целым числом, без запроса к БД и сравнения строк.
+namespace Permissions {
+    using Mask = uint32_t;
+
+    constexpr Mask NONE = 0;
+    constexpr Mask VIEW_DATA = 1u << 0;          // Списки студентов и оценок, прогнозы
+    constexpr Mask MANAGE_STUDENTS = 1u << 1;    // /api/admin/students/*
+    constexpr Mask MANAGE_GRADES = 1u << 2;      // /api/admin/grades/*
+    constexpr Mask VIEW_SERVER_STATS = 1u << 3;  // /api/admin/pool и другие служебные счетчики
+    constexpr Mask EXPORT_DATA = 1u << 4;        // /api/export - выгрузка всей таблицы оценок
+
+    constexpr Mask USER = VIEW_DATA;
+    constexpr Mask ADMIN = VIEW_DATA | MANAGE_STUDENTS | MANAGE_GRADES | VIEW_SERVER_STATS | EXPORT_DATA;
+
+    // Маска для роли из таблицы users; неизвестная роль получает права обычного пользователя
+    inline Mask forRole(const std::string& role) {
+        if (role == "admin") {
+            return ADMIN;
+        }
+        return USER;
+    }
+
+    // Есть ли все права из required
+    constexpr bool allows(Mask granted, Mask required) {
+        return (granted & required) == required;
+    }
+}
+
+#endif
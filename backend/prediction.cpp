@@ -0,0 +1,226 @@
+#include "prediction.h"
+#include <algorithm>
+
+// AVX2-ядро собирается только для x86-64 компиляторами с поддержкой target-атрибутов;
+// выбор между ним и скалярным вариантом делается во время выполнения
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PREDICTION_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+void GradeColumns::reserve(size_t n) {
+    student_id.reserve(n);
+    grade.reserve(n);
+    attendance.reserve(n);
+    assignment.reserve(n);
+}
+
+void GradeColumns::push(const Grade& g) {
+    student_id.push_back(g.student_id);
+    grade.push_back(g.grade);
+    attendance.push_back(g.attendance_percent);
+    assignment.push_back(g.assignment_completion);
+}
+
+namespace Predictor {
+
+    Prediction fromSums(int student_id, double sumGrade, double sumAttendance, double sumAssignment, int count) {
+        Prediction p;
+        p.student_id = student_id;
+        if (count <= 0) {
+            return p;
+        }
+        p.has_data = true;
+
+        double avgGrade = sumGrade / count;
+        double avgAttendance = sumAttendance / count;
+        double avgAssignment = sumAssignment / count;
+
+        // Простая формула прогноза: средние оценки * веса посещаемости и выполнения заданий
+        p.score = (avgGrade * 0.5) + (avgAttendance / 20.0 * 0.25) + (avgAssignment / 20.0 * 0.25);
+
+        if (p.score >= 4.5) {
+            p.predicted_grade = 5;
+            p.probability = (int)(p.score * 20);
+        } else if (p.score >= 3.5) {
+            p.predicted_grade = 4;
+            p.probability = (int)(p.score * 20);
+        } else if (p.score >= 2.5) {
+            p.predicted_grade = 3;
+            p.probability = (int)(p.score * 18);
+        } else {
+            p.predicted_grade = 2;
+            p.probability = (int)((5.0 - p.score) * 15);
+        }
+        return p;
+    }
+
+    Prediction predictStudent(int student_id, const std::vector<Grade>& grades) {
+        double sumGrade = 0.0;
+        double sumAttendance = 0.0;
+        double sumAssignment = 0.0;
+        for (const auto& grade : grades) {
+            sumGrade += grade.grade;
+            sumAttendance += grade.attendance_percent;
+            sumAssignment += grade.assignment_completion;
+        }
+        return fromSums(student_id, sumGrade, sumAttendance, sumAssignment, (int)grades.size());
+    }
+
+    std::vector<size_t> segmentStarts(const GradeColumns& columns) {
+        std::vector<size_t> starts;
+        size_t n = columns.size();
+        for (size_t i = 0; i < n; i++) {
+            if (i == 0 || columns.student_id[i] != columns.student_id[i - 1]) {
+                starts.push_back(i);
+            }
+        }
+        starts.push_back(n);
+        return starts;
+    }
+
+    void sumSegmentsScalar(const GradeColumns& columns, const std::vector<size_t>& starts, SegmentSums& sums) {
+        size_t segments = starts.size() - 1;
+        for (size_t s = 0; s < segments; s++) {
+            double sumGrade = 0.0;
+            double sumAttendance = 0.0;
+            double sumAssignment = 0.0;
+            for (size_t i = starts[s]; i < starts[s + 1]; i++) {
+                sumGrade += columns.grade[i];
+                sumAttendance += columns.attendance[i];
+                sumAssignment += columns.assignment[i];
+            }
+            sums.grade[s] = sumGrade;
+            sums.attendance[s] = sumAttendance;
+            sums.assignment[s] = sumAssignment;
+        }
+    }
+
+#ifdef PREDICTION_HAVE_AVX2
+    // Четыре студента на регистр: каждая полоса суммирует свой блок строк
+    // по порядку, поэтому суммы совпадают со скалярными побитово.
+    // FMA намеренно не включается - она изменила бы округление.
+    __attribute__((target("avx2")))
+    void sumSegmentsAvx2(const GradeColumns& columns, const std::vector<size_t>& starts, SegmentSums& sums) {
+        size_t segments = starts.size() - 1;
+        const double* grade = columns.grade.data();
+        const double* attendance = columns.attendance.data();
+        const double* assignment = columns.assignment.data();
+        const __m256i one = _mm256_set1_epi64x(1);
+
+        size_t s = 0;
+        for (; s + 4 <= segments; s += 4) {
+            __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&starts[s]));
+            __m256i end = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&starts[s + 1]));
+
+            size_t maxLen = 0;
+            for (size_t j = 0; j < 4; j++) {
+                maxLen = std::max(maxLen, starts[s + j + 1] - starts[s + j]);
+            }
+
+            __m256d accGrade = _mm256_setzero_pd();
+            __m256d accAttendance = _mm256_setzero_pd();
+            __m256d accAssignment = _mm256_setzero_pd();
+            for (size_t k = 0; k < maxLen; k++) {
+                // Полосы, чей блок уже закончился, получают 0.0 и не читают память
+                __m256d active = _mm256_castsi256_pd(_mm256_cmpgt_epi64(end, idx));
+                accGrade = _mm256_add_pd(accGrade,
+                    _mm256_mask_i64gather_pd(_mm256_setzero_pd(), grade, idx, active, 8));
+                accAttendance = _mm256_add_pd(accAttendance,
+                    _mm256_mask_i64gather_pd(_mm256_setzero_pd(), attendance, idx, active, 8));
+                accAssignment = _mm256_add_pd(accAssignment,
+                    _mm256_mask_i64gather_pd(_mm256_setzero_pd(), assignment, idx, active, 8));
+                idx = _mm256_add_epi64(idx, one);
+            }
+
+            _mm256_storeu_pd(&sums.grade[s], accGrade);
+            _mm256_storeu_pd(&sums.attendance[s], accAttendance);
+            _mm256_storeu_pd(&sums.assignment[s], accAssignment);
+        }
+
+        // Оставшиеся (меньше четырех) студенты
+        for (; s < segments; s++) {
+            double sumGrade = 0.0;
+            double sumAttendance = 0.0;
+            double sumAssignment = 0.0;
+            for (size_t i = starts[s]; i < starts[s + 1]; i++) {
+                sumGrade += grade[i];
+                sumAttendance += attendance[i];
+                sumAssignment += assignment[i];
+            }
+            sums.grade[s] = sumGrade;
+            sums.attendance[s] = sumAttendance;
+            sums.assignment[s] = sumAssignment;
+        }
+    }
+#endif
+
+    bool avx2Supported() {
+#ifdef PREDICTION_HAVE_AVX2
+        static const bool avx2 = __builtin_cpu_supports("avx2");
+        return avx2;
+#else
+        return false;
+#endif
+    }
+
+    const char* kernelName(Kernel kernel) {
+        switch (kernel) {
+            case Kernel::Avx2: return "avx2";
+            case Kernel::Scalar: return "scalar";
+            default: return "auto";
+        }
+    }
+
+    std::vector<Prediction> predictAll(const GradeColumns& columns, Kernel kernel) {
+        // Каждая полоса AVX2 собирает строки своего студента по одной (три gather на строку)
+        // и простаивает, пока не закончится самый длинный из четырех блоков, - на реальных
+        // данных это не быстрее скалярного прохода, поэтому по умолчанию - Scalar
+        if (kernel == Kernel::Auto || (kernel == Kernel::Avx2 && !avx2Supported())) {
+            kernel = Kernel::Scalar;
+        }
+
+        std::vector<size_t> starts = segmentStarts(columns);
+        size_t segments = starts.size() - 1;
+
+        SegmentSums sums;
+        sums.grade.resize(segments);
+        sums.attendance.resize(segments);
+        sums.assignment.resize(segments);
+
+#ifdef PREDICTION_HAVE_AVX2
+        if (kernel == Kernel::Avx2) {
+            sumSegmentsAvx2(columns, starts, sums);
+        } else {
+            sumSegmentsScalar(columns, starts, sums);
+        }
+#else
+        sumSegmentsScalar(columns, starts, sums);
+#endif
+
+        std::vector<Prediction> predictions;
+        predictions.reserve(segments);
+        for (size_t s = 0; s < segments; s++) {
+            predictions.push_back(fromSums(columns.student_id[starts[s]], sums.grade[s], sums.attendance[s],
+                                           sums.assignment[s], (int)(starts[s + 1] - starts[s])));
+        }
+        return predictions;
+    }
+
+    std::string label(int predicted_grade) {
+        switch (predicted_grade) {
+            case 5: return "Отлично";
+            case 4: return "Хорошо";
+            case 3: return "Удовлетворительно";
+            default: return "Неудовлетворительно";
+        }
+    }
+
+    std::string describe(const Prediction& prediction) {
+        if (!prediction.has_data) {
+            return "Недостаточно данных для прогноза";
+        }
+        return label(prediction.predicted_grade) + " (" + std::to_string(prediction.predicted_grade) +
+               ") - вероятность: " + std::to_string(prediction.probability) + "%";
+    }
+}
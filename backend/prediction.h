@@ -0,0 +1,72 @@
+#ifndef PREDICTION_H
+#define PREDICTION_H
+
+#include "models.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Результат прогноза для одного студента
+struct Prediction {
+    int student_id = 0;
+    bool has_data = false;      // false - у студента нет оценок
+    double score = 0.0;         // prediction_score (см. ALGORITHM.md)
+    int predicted_grade = 0;    // 2..5
+    int probability = 0;        // Вероятность, %
+};
+
+// Входные данные прогноза в виде столбцов: строки одного студента идут подряд
+struct GradeColumns {
+    std::vector<int> student_id;
+    std::vector<double> grade;
+    std::vector<double> attendance;
+    std::vector<double> assignment;
+
+    void reserve(size_t n);
+    void push(const Grade& g);
+    size_t size() const { return student_id.size(); }
+};
+
+// Суммы показателей по блокам строк (по одному элементу на студента)
+struct SegmentSums {
+    std::vector<double> grade;
+    std::vector<double> attendance;
+    std::vector<double> assignment;
+};
+
+namespace Predictor {
+    // Реализация суммирования в predictAll
+    enum class Kernel {
+        Auto,       // Scalar: AVX2 на сборе строк (gather) не быстрее, см. make bench-predict
+        Scalar,
+        Avx2        // Только если процессор его поддерживает, иначе Scalar
+    };
+
+    // Есть ли AVX2-ядро в сборке и поддерживает ли его процессор
+    bool avx2Supported();
+    const char* kernelName(Kernel kernel);
+
+    // Начала блоков строк одного студента; последний элемент - columns.size()
+    std::vector<size_t> segmentStarts(const GradeColumns& columns);
+
+    // Суммы показателей по блокам (sums должен иметь по starts.size() - 1 элементов)
+    void sumSegmentsScalar(const GradeColumns& columns, const std::vector<size_t>& starts, SegmentSums& sums);
+
+    // Прогноз по суммам показателей студента
+    Prediction fromSums(int student_id, double sumGrade, double sumAttendance, double sumAssignment, int count);
+
+    // Прогноз по оценкам одного студента (суммы - в порядке строк, как в кэше и predictAll)
+    Prediction predictStudent(int student_id, const std::vector<Grade>& grades);
+
+    // Прогноз для каждого непрерывного блока строк одного студента, за один проход.
+    // Все ядра дают побитово одинаковый результат
+    std::vector<Prediction> predictAll(const GradeColumns& columns, Kernel kernel = Kernel::Auto);
+
+    // Название прогнозируемой оценки: "Отлично", "Хорошо", ...
+    std::string label(int predicted_grade);
+
+    // Текст прогноза, как его показывает /api/predict
+    std::string describe(const Prediction& prediction);
+}
+
+#endif
@@ -1,34 +1,121 @@
 #ifndef QUERIES_H
 #define QUERIES_H
 
-#include <string>
+#include <cstddef>
+
+// Все SQL запросы приложения: X(идентификатор, текст запроса).
+// Каждый запрос подготавливается (PREPARE) на каждом соединении пула один раз
+// под именем, равным идентификатору, и вызывается через Queries::Id, поэтому
+// опечатка в имени запроса - ошибка компиляции, а не ошибка во время работы.
+#define QUERIES_LIST(X) \
+    /* Users queries */ \
+    X(CHECK_USER_EXISTS, "SELECT id FROM users WHERE username = $1") \
+    X(CHECK_EMAIL_EXISTS, "SELECT id FROM users WHERE email = $1") \
+    /* Какое из уникальных полей уже занято: 'username', 'email' или NULL */ \
+    X(FIND_USER_CONFLICT, "SELECT CASE WHEN EXISTS (SELECT 1 FROM users WHERE username = $1) THEN 'username' " \
+                          "WHEN EXISTS (SELECT 1 FROM users WHERE email = $2) THEN 'email' END") \
+    /* Регистрация за один запрос: id новой строки или NULL и имя занятого поля. */ \
+    /* ON CONFLICT DO NOTHING не сообщает имя ограничения, поэтому поле ищется по индексам; */ \
+    /* EXISTS вычисляются лениво - только если строка не вставлена */ \
+    X(INSERT_USER, "WITH inserted AS (" \
+                   "INSERT INTO users (username, password, email, role) VALUES ($1, $2, $3, $4) " \
+                   "ON CONFLICT DO NOTHING RETURNING id) " \
+                   "SELECT (SELECT id FROM inserted), " \
+                   "CASE WHEN (SELECT id FROM inserted) IS NOT NULL THEN NULL " \
+                   "WHEN EXISTS (SELECT 1 FROM users WHERE username = $1) THEN 'username' " \
+                   "WHEN EXISTS (SELECT 1 FROM users WHERE email = $3) THEN 'email' END") \
+    X(GET_USER_BY_USERNAME, "SELECT id, username, email, role, password FROM users WHERE username = $1") \
+    X(SET_USER_ROLE, "UPDATE users SET role = $1 WHERE username = $2") \
+    X(UPDATE_USER_PASSWORD, "UPDATE users SET password = $1 WHERE id = $2 AND password = $3") \
+    \
+    /* Students queries */ \
+    X(GET_ALL_STUDENTS, "SELECT id, name, surname, group_name FROM students ORDER BY id") \
+    X(GET_STUDENT_BY_ID, "SELECT id, name, surname, group_name FROM students WHERE id = $1") \
+    /* txid_current() в RETURNING изменений - транзакция, по ней поправка кэша после коммита */ \
+    /* сопоставляется с уведомлением об этой же транзакции (Database::patchOwnChange) */ \
+    X(INSERT_STUDENT, "INSERT INTO students (name, surname, group_name) VALUES ($1, $2, $3) " \
+                      "RETURNING id, name, surname, group_name, txid_current()") \
+    X(UPDATE_STUDENT, "UPDATE students SET name = $1, surname = $2, group_name = $3 WHERE id = $4 " \
+                      "RETURNING id, name, surname, group_name, txid_current()") \
+    X(DELETE_STUDENT, "DELETE FROM students WHERE id = $1") \
+    X(GET_ALL_STUDENT_IDS, "SELECT id FROM students") \
+    /* Страницы студентов по ключу: id > $after ORDER BY id LIMIT $limit */ \
+    X(GET_STUDENTS_PAGE, "SELECT id, name, surname, group_name FROM students " \
+                         "WHERE id > $1 ORDER BY id LIMIT $2") \
+    X(GET_STUDENTS_PAGE_BY_GROUP, "SELECT id, name, surname, group_name FROM students " \
+                                  "WHERE group_name = $1 AND id > $2 ORDER BY id LIMIT $3") \
+    \
+    /* Grades queries */ \
+    /* Оценки студента - по semester, subject (побайтно, как в кэше), id: в этом порядке */ \
+    /* суммируются показатели для прогноза, поэтому он один и тот же с кэшем и без */ \
+    X(GET_STUDENT_GRADES, "SELECT id, student_id, subject, grade, semester, attendance_percent, assignment_completion, exam_result " \
+                          "FROM student_grades WHERE student_id = $1 ORDER BY semester, subject COLLATE \"C\", id") \
+    X(GET_ALL_GRADES, "SELECT id, student_id, subject, grade, semester, attendance_percent, assignment_completion, exam_result " \
+                      "FROM student_grades ORDER BY student_id, semester, subject COLLATE \"C\", id") \
+    /* Оценки нескольких студентов ($1 - массив id, '{1,2,3}') для прогноза без кэша */ \
+    X(GET_GRADES_FOR_STUDENTS, "SELECT id, student_id, subject, grade, semester, attendance_percent, assignment_completion, exam_result " \
+                               "FROM student_grades WHERE student_id = ANY($1::int[]) ORDER BY student_id, semester, subject COLLATE \"C\", id") \
+    X(GET_GRADE_BY_ID, "SELECT id, student_id, subject, grade, semester, attendance_percent, assignment_completion, exam_result " \
+                       "FROM student_grades WHERE id = $1") \
+    X(INSERT_GRADE, "INSERT INTO student_grades (student_id, subject, grade, semester, attendance_percent, assignment_completion, exam_result) " \
+                    "VALUES ($1, $2, $3, $4, $5, $6, $7) " \
+                    "RETURNING id, student_id, subject, grade, semester, attendance_percent, assignment_completion, exam_result, txid_current()") \
+    X(UPDATE_GRADE, "UPDATE student_grades SET subject = $1, grade = $2, semester = $3, attendance_percent = $4, " \
+                    "assignment_completion = $5, exam_result = $6 WHERE id = $7 " \
+                    "RETURNING id, student_id, subject, grade, semester, attendance_percent, assignment_completion, exam_result, txid_current()") \
+    X(DELETE_GRADE, "DELETE FROM student_grades WHERE id = $1") \
+    /* Массовый импорт: построчные уведомления отключаются до конца транзакции, */ \
+    /* вместо них после загрузки отправляется одно уведомление RELOAD */ \
+    X(BEGIN_BULK_IMPORT, "SELECT set_config('app.bulk_import', 'on', true)") \
+    X(NOTIFY_GRADES_RELOAD, "SELECT pg_notify('data_changes', 'student_grades:RELOAD:0:' || " \
+                            "COALESCE(current_setting('app.instance', true), ''))") \
+    /* Общий счетчик изменений студентов и оценок (последовательность, триггеры bump_data_version) */ \
+    X(GET_DATA_VERSION, "SELECT last_value FROM data_version") \
+    /* Страницы оценок по ключу. Для каждого ведущего фильтра свой запрос и свой */ \
+    /* индекс (фильтр, id); остальные фильтры необязательны: '' и 0 - без фильтра */ \
+    X(GET_GRADES_PAGE, "SELECT id, student_id, subject, grade, semester, attendance_percent, assignment_completion, exam_result " \
+                       "FROM student_grades WHERE id > $1 ORDER BY id LIMIT $2") \
+    X(GET_GRADES_PAGE_BY_STUDENT, "SELECT id, student_id, subject, grade, semester, attendance_percent, assignment_completion, exam_result " \
+                                  "FROM student_grades WHERE student_id = $1 AND id > $2 " \
+                                  "AND ($3::text = '' OR subject = $3::text) AND ($4::int = 0 OR semester = $4::int) " \
+                                  "ORDER BY id LIMIT $5") \
+    X(GET_GRADES_PAGE_BY_SUBJECT, "SELECT id, student_id, subject, grade, semester, attendance_percent, assignment_completion, exam_result " \
+                                  "FROM student_grades WHERE subject = $1 AND id > $2 " \
+                                  "AND ($3::int = 0 OR semester = $3::int) ORDER BY id LIMIT $4") \
+    X(GET_GRADES_PAGE_BY_SEMESTER, "SELECT id, student_id, subject, grade, semester, attendance_percent, assignment_completion, exam_result " \
+                                   "FROM student_grades WHERE semester = $1 AND id > $2 ORDER BY id LIMIT $3")
 
 namespace Queries {
-    // Users queries
-    const std::string CHECK_USER_EXISTS = "SELECT id FROM users WHERE username = $1";
-    const std::string CHECK_EMAIL_EXISTS = "SELECT id FROM users WHERE email = $1";
-    const std::string INSERT_USER = "INSERT INTO users (username, password, email) VALUES ($1, $2, $3)";
-    const std::string INSERT_USER_WITH_ROLE = "INSERT INTO users (username, password, email, role) VALUES ($1, $2, $3, $4)";
-    const std::string GET_USER_BY_USERNAME = "SELECT id, username, email, role, password FROM users WHERE username = $1";
-    const std::string GET_USER_ROLE = "SELECT role FROM users WHERE id = $1";
-    
-    // Students queries
-    const std::string GET_ALL_STUDENTS = "SELECT id, name, surname, group_name FROM students ORDER BY id";
-    const std::string INSERT_STUDENT = "INSERT INTO students (name, surname, group_name) VALUES ($1, $2, $3)";
-    const std::string UPDATE_STUDENT = "UPDATE students SET name = $1, surname = $2, group_name = $3 WHERE id = $4";
-    const std::string DELETE_STUDENT = "DELETE FROM students WHERE id = $1";
-    
-    // Grades queries
-    const std::string GET_STUDENT_GRADES = "SELECT id, student_id, subject, grade, semester, attendance_percent, assignment_completion, exam_result "
-                                           "FROM student_grades WHERE student_id = $1 ORDER BY semester, subject";
-    const std::string GET_ALL_GRADES = "SELECT id, student_id, subject, grade, semester, attendance_percent, assignment_completion, exam_result "
-                                       "FROM student_grades ORDER BY student_id, semester, subject";
-    const std::string INSERT_GRADE = "INSERT INTO student_grades (student_id, subject, grade, semester, attendance_percent, assignment_completion, exam_result) "
-                                     "VALUES ($1, $2, $3, $4, $5, $6, $7)";
-    const std::string UPDATE_GRADE = "UPDATE student_grades SET subject = $1, grade = $2, semester = $3, attendance_percent = $4, "
-                                     "assignment_completion = $5, exam_result = $6 WHERE id = $7";
-    const std::string DELETE_GRADE = "DELETE FROM student_grades WHERE id = $1";
+    // Идентификаторы запросов
+    enum class Id {
+#define QUERIES_ENUM(id, sql) id,
+        QUERIES_LIST(QUERIES_ENUM)
+#undef QUERIES_ENUM
+        COUNT
+    };
+
+    constexpr size_t COUNT = static_cast<size_t>(Id::COUNT);
+
+    inline constexpr const char* NAMES[] = {
+#define QUERIES_NAME(id, sql) #id,
+        QUERIES_LIST(QUERIES_NAME)
+#undef QUERIES_NAME
+    };
+
+    inline constexpr const char* TEXTS[] = {
+#define QUERIES_TEXT(id, sql) sql,
+        QUERIES_LIST(QUERIES_TEXT)
+#undef QUERIES_TEXT
+    };
+
+    static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == COUNT, "Queries: имена не совпадают со списком");
+    static_assert(sizeof(TEXTS) / sizeof(TEXTS[0]) == COUNT, "Queries: тексты не совпадают со списком");
+
+    // Имя подготовленного запроса
+    constexpr const char* name(Id id) { return NAMES[static_cast<size_t>(id)]; }
+
+    // Текст запроса
+    constexpr const char* sql(Id id) { return TEXTS[static_cast<size_t>(id)]; }
 }
 
 #endif
-
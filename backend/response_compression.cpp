@@ -0,0 +1,247 @@
+#include "response_compression.h"
+#include "metrics.h"
+#include <zlib.h>
+#include <zstd.h>
+#include <cstdlib>
+#include <utility>
+
+namespace {
+    // Размер порции выходного буфера кодировщиков
+    const size_t OUTPUT_STEP = 16 * 1024;
+
+    class GzipEncoder : public StreamEncoder {
+    private:
+        z_stream stream{};
+        bool ready = false;
+
+    public:
+        explicit GzipEncoder(int level) {
+            // 15 + 16: окно 32 КБ с заголовком gzip
+            ready = deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+        }
+
+        ~GzipEncoder() override {
+            if (ready) {
+                deflateEnd(&stream);
+            }
+        }
+
+        bool encode(const char* data, size_t size, bool finish, std::string& out) override {
+            if (!ready) {
+                return false;
+            }
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+            stream.avail_in = (uInt)size;
+            int flush = finish ? Z_FINISH : Z_NO_FLUSH;
+            while (true) {
+                size_t offset = out.size();
+                out.resize(offset + OUTPUT_STEP);
+                stream.next_out = reinterpret_cast<Bytef*>(&out[offset]);
+                stream.avail_out = (uInt)OUTPUT_STEP;
+                int rc = deflate(&stream, flush);
+                out.resize(offset + OUTPUT_STEP - stream.avail_out);
+                if (rc == Z_STREAM_ERROR) {
+                    return false;
+                }
+                // Буфер заполнен не до конца - весь вход обработан (при Z_FINISH ждем конец потока)
+                if (finish ? rc == Z_STREAM_END : stream.avail_out != 0) {
+                    return true;
+                }
+            }
+        }
+    };
+
+    class ZstdEncoder : public StreamEncoder {
+    private:
+        ZSTD_CCtx* context;
+
+    public:
+        explicit ZstdEncoder(int level) : context(ZSTD_createCCtx()) {
+            if (context) {
+                ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, level);
+            }
+        }
+
+        ~ZstdEncoder() override {
+            ZSTD_freeCCtx(context);
+        }
+
+        bool encode(const char* data, size_t size, bool finish, std::string& out) override {
+            if (!context) {
+                return false;
+            }
+            ZSTD_inBuffer input{data, size, 0};
+            ZSTD_EndDirective mode = finish ? ZSTD_e_end : ZSTD_e_continue;
+            while (true) {
+                size_t offset = out.size();
+                out.resize(offset + OUTPUT_STEP);
+                ZSTD_outBuffer output{&out[offset], OUTPUT_STEP, 0};
+                size_t remaining = ZSTD_compressStream2(context, &output, &input, mode);
+                out.resize(offset + output.pos);
+                if (ZSTD_isError(remaining)) {
+                    return false;
+                }
+                // e_end: пока remaining != 0, во внутренних буферах еще есть данные
+                if (finish ? remaining == 0 : input.pos == input.size) {
+                    return true;
+                }
+            }
+        }
+    };
+
+    bool isCompressible(const std::string& content_type) {
+        return content_type.rfind("application/json", 0) == 0 || content_type.rfind("text/", 0) == 0;
+    }
+}
+
+ResponseCompression::ResponseCompression(const CompressionConfig& config) : config(config) {}
+
+bool ResponseCompression::accepts(const std::string& header, const std::string& coding) {
+    size_t pos = 0;
+    while (pos < header.size()) {
+        size_t end = header.find(',', pos);
+        if (end == std::string::npos) {
+            end = header.size();
+        }
+        std::string item = header.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t first = item.find_first_not_of(" \t");
+        if (first == std::string::npos) {
+            continue;
+        }
+        size_t semicolon = item.find(';', first);
+        std::string name = item.substr(first, semicolon == std::string::npos ? std::string::npos : semicolon - first);
+        name.erase(name.find_last_not_of(" \t") + 1);
+        if (name != coding && name != "*") {
+            continue;
+        }
+        if (semicolon != std::string::npos) {
+            size_t q = item.find("q=", semicolon);
+            if (q != std::string::npos && std::strtod(item.c_str() + q + 2, nullptr) <= 0.0) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+const char* ResponseCompression::name(ContentCoding coding) {
+    switch (coding) {
+        case ContentCoding::Gzip: return "gzip";
+        case ContentCoding::Zstd: return "zstd";
+        default: return "identity";
+    }
+}
+
+ContentCoding ResponseCompression::negotiate(const httplib::Request& req) const {
+    if (!config.enabled) {
+        return ContentCoding::Identity;
+    }
+    std::string header = req.get_header_value("Accept-Encoding");
+    if (accepts(header, "zstd")) {
+        return ContentCoding::Zstd;
+    }
+    if (accepts(header, "gzip")) {
+        return ContentCoding::Gzip;
+    }
+    return ContentCoding::Identity;
+}
+
+std::unique_ptr<StreamEncoder> ResponseCompression::makeEncoder(ContentCoding coding) const {
+    if (coding == ContentCoding::Zstd) {
+        return std::make_unique<ZstdEncoder>(config.zstd_level);
+    }
+    return std::make_unique<GzipEncoder>(config.gzip_level);
+}
+
+void ResponseCompression::record(ContentCoding coding, size_t before, size_t after) {
+    responses++;
+    (coding == ContentCoding::Zstd ? zstd_responses : gzip_responses)++;
+    identity_bytes += before;
+    compressed_bytes += after;
+}
+
+void ResponseCompression::compressBody(const httplib::Request& req, httplib::Response& res) {
+    if (res.status != 200 || res.body.size() < config.min_bytes || res.has_header("Content-Encoding") ||
+        !isCompressible(res.get_header_value("Content-Type"))) {
+        return;
+    }
+    res.set_header("Vary", "Accept-Encoding");
+    ContentCoding coding = negotiate(req);
+    if (coding == ContentCoding::Identity) {
+        return;
+    }
+
+    std::string compressed;
+    compressed.reserve(res.body.size() / 4 + 64);
+    if (!makeEncoder(coding)->encode(res.body.data(), res.body.size(), true, compressed) ||
+        compressed.size() >= res.body.size()) {
+        return;     // Ответ как есть
+    }
+    record(coding, res.body.size(), compressed.size());
+    res.body = std::move(compressed);
+    res.set_header("Content-Encoding", name(coding));
+}
+
+void ResponseCompression::setChunkedContent(const httplib::Request& req, httplib::Response& res,
+                                            const std::string& content_type, ChunkProducer producer) {
+    ContentCoding coding = negotiate(req);
+    if (config.enabled) {
+        res.set_header("Vary", "Accept-Encoding");
+    }
+    if (coding == ContentCoding::Identity) {
+        res.set_chunked_content_provider(content_type, [producer](size_t, httplib::DataSink& sink) {
+            if (!producer([&sink](const char* data, size_t size) {
+                    Metrics::addResponseBytes(size);
+                    return sink.write(data, size);
+                })) {
+                return false;
+            }
+            sink.done();
+            return true;
+        });
+        return;
+    }
+
+    res.set_header("Content-Encoding", name(coding));
+    res.set_chunked_content_provider(content_type, [this, coding, producer](size_t, httplib::DataSink& sink) {
+        std::unique_ptr<StreamEncoder> encoder = makeEncoder(coding);
+        std::string out;
+        size_t before = 0;
+        size_t after = 0;
+        bool ok = producer([&](const char* data, size_t size) {
+            Metrics::addResponseBytes(size);
+            before += size;
+            if (!encoder->encode(data, size, false, out)) {
+                return false;
+            }
+            if (out.empty()) {
+                return true;    // Кодировщик пока копит данные
+            }
+            after += out.size();
+            bool client_alive = sink.write(out.data(), out.size());
+            out.clear();
+            return client_alive;
+        });
+        if (!ok || !encoder->encode(nullptr, 0, true, out)) {
+            return false;
+        }
+        after += out.size();
+        sink.write(out.data(), out.size());
+        sink.done();
+        record(coding, before, after);
+        return true;
+    });
+}
+
+CompressionStats ResponseCompression::stats() const {
+    CompressionStats result;
+    result.responses = responses.load();
+    result.gzip = gzip_responses.load();
+    result.zstd = zstd_responses.load();
+    result.identity_bytes = identity_bytes.load();
+    result.compressed_bytes = compressed_bytes.load();
+    return result;
+}
@@ -0,0 +1,88 @@
+#ifndef RESPONSE_COMPRESSION_H
+#define RESPONSE_COMPRESSION_H
+
+#include "httplib.h"
+#include <string>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+// Кодирование тела ответа (Content-Encoding)
+enum class ContentCoding {
+    Identity,
+    Gzip,
+    Zstd
+};
+
+struct CompressionConfig {
+    bool enabled = true;
+    size_t min_bytes = 1024;    // Ответы меньше этого размера отправляются как есть
+    int gzip_level = 6;         // 1..9
+    int zstd_level = 3;         // 1..19
+};
+
+struct CompressionStats {
+    uint64_t responses = 0;         // Сжатых ответов
+    uint64_t gzip = 0;              // Из них gzip
+    uint64_t zstd = 0;              // Из них zstd
+    uint64_t identity_bytes = 0;    // Размер сжатых ответов до сжатия
+    uint64_t compressed_bytes = 0;  // И после
+};
+
+// Потоковый кодировщик одного ответа
+class StreamEncoder {
+public:
+    virtual ~StreamEncoder() = default;
+
+    // Сжать size байт из data и дописать результат в out.
+    // finish = true - последний кусок (дописывается и конец потока). false при ошибке
+    virtual bool encode(const char* data, size_t size, bool finish, std::string& out) = 0;
+};
+
+// Сжатие ответов API по Accept-Encoding: zstd, если клиент его принимает, иначе gzip.
+// Готовые ответы (set_content) сжимаются целиком в post-routing обработчике,
+// потоковые (chunked) - по мере записи через setChunkedContent
+class ResponseCompression {
+public:
+    // Записать очередной кусок тела; false - клиент отключился
+    using ChunkWriter = std::function<bool(const char* data, size_t size)>;
+    // Сформировать все тело через write; false - оборвать ответ
+    using ChunkProducer = std::function<bool(const ChunkWriter& write)>;
+
+private:
+    CompressionConfig config;
+
+    std::atomic<uint64_t> responses{0};
+    std::atomic<uint64_t> gzip_responses{0};
+    std::atomic<uint64_t> zstd_responses{0};
+    std::atomic<uint64_t> identity_bytes{0};
+    std::atomic<uint64_t> compressed_bytes{0};
+
+    std::unique_ptr<StreamEncoder> makeEncoder(ContentCoding coding) const;
+    void record(ContentCoding coding, size_t before, size_t after);
+
+public:
+    explicit ResponseCompression(const CompressionConfig& config = CompressionConfig());
+
+    // Кодирование для ответа на req (Identity, если сжатие выключено или клиент его не принимает)
+    ContentCoding negotiate(const httplib::Request& req) const;
+
+    // Сжать готовое тело ответа, если оно достаточно большое и его тип сжимается.
+    // Ответы, у которых уже есть Content-Encoding (файлы фронтенда), не трогаются
+    void compressBody(const httplib::Request& req, httplib::Response& res);
+
+    // Как res.set_chunked_content_provider, но все, что producer пишет, сжимается на лету.
+    // Размер потока заранее не известен, поэтому порог min_bytes здесь не применяется
+    void setChunkedContent(const httplib::Request& req, httplib::Response& res,
+                           const std::string& content_type, ChunkProducer producer);
+
+    CompressionStats stats() const;
+
+    // Разрешено ли кодирование coding в заголовке Accept-Encoding (учитывается q=0)
+    static bool accepts(const std::string& header, const std::string& coding);
+    static const char* name(ContentCoding coding);
+};
+
+#endif
@@ -1,46 +1,299 @@
 #include "database.h"
 #include "httplib.h"
-#include <iostream>
+#include "json_writer.h"
+#include "api_json.h"
+#include "session_store.h"
+#include "permissions.h"
+#include "task_queue.h"
+#include "static_assets.h"
+#include "response_compression.h"
+#include "password_hash.h"
+#include "metrics.h"
+#include "log.h"
 #include <sstream>
-#include <fstream>
-#include <map>
 #include <string>
 #include <cstdlib>
-#include <ctime>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include <cstdint>
+#include <initializer_list>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <charconv>
 
-// Простая сессия (в реальном приложении использовать JWT или cookies)
-std::map<std::string, User*> sessions;
-std::string generateSessionId() {
-    return std::to_string(rand() % 1000000);
+
+// Размер порции при потоковой отдаче JSON
+const size_t STREAM_CHUNK_BYTES = 64 * 1024;
+
+// Отдать JSON-массив частями (Transfer-Encoding: chunked): source(visit) вызывает
+// visit для каждого элемента по порядку. Ответ целиком в памяти не собирается
+// и сжимается по мере записи, если клиент это поддерживает
+template<typename T, typename Source>
+void streamJsonArray(const httplib::Request& req, httplib::Response& res, ResponseCompression& compression, Source source) {
+    compression.setChunkedContent(req, res, "application/json", [source](const ResponseCompression::ChunkWriter& write) {
+        JsonWriter json(STREAM_CHUNK_BYTES + 4096);
+        bool client_alive = true;
+        
+        json.beginArray();
+        bool ok = source([&](const T& item) {
+            ApiJson::write(json, item);
+            if (json.size() >= STREAM_CHUNK_BYTES) {
+                client_alive = write(json.str().data(), json.size());
+                json.clear();
+            }
+            return client_alive;
+        });
+        if (!ok || !client_alive) {
+            return false;   // Ошибка БД на середине: оборвать ответ, а не закрыть массив
+        }
+        json.endArray();
+        return write(json.str().data(), json.size());
+    });
+}
+
+// Размер страницы при постраничной выдаче списков
+const long DEFAULT_PAGE_LIMIT = 100;
+const long MAX_PAGE_LIMIT = 1000;
+
+// Запрошена ли страница (хотя бы один из параметров пагинации или фильтров)
+bool isPageRequest(const httplib::Request& req, std::initializer_list<const char*> params) {
+    for (const char* name : params) {
+        if (req.has_param(name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Целочисленный параметр; отсутствует - default_value. false, если значение некорректно
+bool readIntParam(const httplib::Request& req, const char* name, long min_value, long max_value,
+                  long default_value, long& out) {
+    if (!req.has_param(name)) {
+        out = default_value;
+        return true;
+    }
+    try {
+        size_t pos = 0;
+        std::string value = req.get_param_value(name);
+        out = std::stol(value, &pos);
+        return pos == value.size() && out >= min_value && out <= max_value;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+// Страница списка: {"items": [...], "next_after_id": id последней строки или null}
+template<typename T>
+void sendPage(httplib::Response& res, const std::vector<T>& items, bool has_more) {
+    JsonWriter json(64 + items.size() * 160);
+    json.beginObject().key("items");
+    ApiJson::writeArray(json, items);
+    json.key("next_after_id");
+    if (has_more && !items.empty()) {
+        json.value(items.back().id);
+    } else {
+        json.null();
+    }
+    json.endObject();
+    res.set_content(json.take(), "application/json");
+}
+
+// ETag ответа, который зависит только от данных студентов и оценок (пусто - без ETag).
+// Версия берется до чтения данных: запись, закоммиченная во время чтения,
+// только раньше сделает ETag устаревшим, но не пометит старые данные новой версией
+std::string dataETag(Database& db) {
+    std::string tag = db.getDataTag();
+    return tag.empty() ? tag : "W/\"" + tag + "\"";
 }
 
-std::string readFile(const std::string& path) {
-    // Путь относительно корня проекта
-    std::string full_path = "../" + path;
-    if (path.find("/") == 0) {
-        full_path = path;  // Абсолютный путь
+// Ответить 304, если у клиента данные той же версии (If-None-Match); иначе
+// проставить ETag и вернуть false - тогда ответ формируется как обычно
+bool notModified(const httplib::Request& req, httplib::Response& res, const std::string& etag) {
+    if (etag.empty()) {
+        return false;
     }
-    std::ifstream file(full_path);
-    if (!file.is_open()) {
-        // Попробуем без префикса
-        file.open(path);
-        if (!file.is_open()) {
-            return "";
+    res.set_header("ETag", etag);
+    res.set_header("Cache-Control", "private, no-cache");
+    
+    std::string header = req.get_header_value("If-None-Match");
+    std::string opaque = etag.substr(2);    // Слабое сравнение: без префикса W/
+    size_t pos = 0;
+    while (pos < header.size()) {
+        size_t end = header.find(',', pos);
+        if (end == std::string::npos) {
+            end = header.size();
+        }
+        std::string item = header.substr(pos, end - pos);
+        pos = end + 1;
+        
+        size_t first = item.find_first_not_of(" \t");
+        if (first == std::string::npos) {
+            continue;
+        }
+        item = item.substr(first, item.find_last_not_of(" \t") - first + 1);
+        if (item.rfind("W/", 0) == 0) {
+            item.erase(0, 2);
+        }
+        if (item == "*" || item == opaque) {
+            res.status = 304;
+            return true;
         }
     }
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    return false;
 }
 
+// Обработчик, который выполняется только для сессии со всеми правами из required.
+// Через него регистрируются все маршруты /api/admin/*, так что проверка доступа -
+// одна проверка битовой маски в хранилище сессий. set_pre_routing_handler здесь
+// не подходит: он вызывается до чтения тела запроса, а админские формы передают
+// session_id в теле POST-запроса
+httplib::Server::Handler guarded(const SessionStore& sessions, Permissions::Mask required,
+                                 httplib::Server::Handler handler) {
+    return [&sessions, required, handler](const httplib::Request& req, httplib::Response& res) {
+        if (!sessions.authorize(req.get_param_value("session_id"), required)) {
+            res.status = 403;
+            res.set_content(R"({"error": "Доступ запрещен"})", "application/json");
+            return;
+        }
+        handler(req, res);
+    };
+}
+
+// То же для обработчика, который сам читает тело запроса (session_id тогда передается в строке запроса)
+httplib::Server::HandlerWithContentReader guarded(const SessionStore& sessions, Permissions::Mask required,
+                                                  httplib::Server::HandlerWithContentReader handler) {
+    return [&sessions, required, handler](const httplib::Request& req, httplib::Response& res,
+                                          const httplib::ContentReader& content_reader) {
+        if (!sessions.authorize(req.get_param_value("session_id"), required)) {
+            res.status = 403;
+            res.set_content(R"({"error": "Доступ запрещен"})", "application/json");
+            return;
+        }
+        handler(req, res, content_reader);
+    };
+}
+
+// Код и размер ответа в метриках маршрута. Сжатое тело уже учтено при сжатии
+void recordResponse(size_t index, const httplib::Response& res, uint64_t start) {
+    // Код не задан обработчиком - httplib отправит 200
+    Metrics::recordRequest(index, res.status > 0 ? res.status : 200, Metrics::now() - start);
+    if (!res.has_header("Content-Encoding")) {
+        Metrics::addResponseBytes(res.body.size());
+    }
+}
+
+// Обработчик с замером времени и кода ответа для /metrics
+httplib::Server::Handler instrumented(const std::string& route, httplib::Server::Handler handler) {
+    size_t index = Metrics::registerRoute(route);
+    return [index, handler](const httplib::Request& req, httplib::Response& res) {
+        uint64_t start = Metrics::now();
+        try {
+            handler(req, res);
+        } catch (...) {
+            Metrics::recordRequest(index, 500, Metrics::now() - start);
+            throw;
+        }
+        recordResponse(index, res, start);
+    };
+}
+
+httplib::Server::HandlerWithContentReader instrumented(const std::string& route,
+                                                       httplib::Server::HandlerWithContentReader handler) {
+    size_t index = Metrics::registerRoute(route);
+    return [index, handler](const httplib::Request& req, httplib::Response& res,
+                            const httplib::ContentReader& content_reader) {
+        uint64_t start = Metrics::now();
+        try {
+            handler(req, res, content_reader);
+        } catch (...) {
+            Metrics::recordRequest(index, 500, Metrics::now() - start);
+            throw;
+        }
+        recordResponse(index, res, start);
+    };
+}
+
+// Регистрация маршрутов с метриками (имя маршрута в метриках - "МЕТОД шаблон")
+class Routes {
+private:
+    httplib::Server& svr;
+
+public:
+    explicit Routes(httplib::Server& svr) : svr(svr) {}
+
+    void Get(const std::string& pattern, httplib::Server::Handler handler) {
+        svr.Get(pattern, instrumented("GET " + pattern, std::move(handler)));
+    }
+
+    void Post(const std::string& pattern, httplib::Server::Handler handler) {
+        svr.Post(pattern, instrumented("POST " + pattern, std::move(handler)));
+    }
+
+    void Post(const std::string& pattern, httplib::Server::HandlerWithContentReader handler) {
+        svr.Post(pattern, instrumented("POST " + pattern, std::move(handler)));
+    }
+};
+
 std::string getEnvVar(const std::string& key, const std::string& defaultValue) {
     const char* val = std::getenv(key.c_str());
     return val ? std::string(val) : defaultValue;
 }
 
-int main() {
-    // Инициализация генератора случайных чисел
-    srand(time(nullptr));
+// Настройка из командной строки (--name=value или --name value), иначе из переменной окружения
+std::string getSetting(int argc, char* argv[], const std::string& name, const std::string& env_key,
+                       const std::string& defaultValue) {
+    std::string flag = "--" + name;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == flag && i + 1 < argc) {
+            return argv[i + 1];
+        }
+        if (arg.rfind(flag + "=", 0) == 0) {
+            return arg.substr(flag.size() + 1);
+        }
+    }
+    return getEnvVar(env_key, defaultValue);
+}
+
+int main(int argc, char* argv[]) {
+    // Журнал: уровень, ограничение частоты одинаковых записей, буфер каждого потока
+    Log::Config log_config;
+    std::string log_level = getSetting(argc, argv, "log-level", "LOG_LEVEL", "info");
+    bool log_level_known = Log::parseLevel(log_level, log_config.level);
+    log_config.rate_limit = std::stoul(getSetting(argc, argv, "log-rate-limit", "LOG_RATE_LIMIT", "100"));
+    log_config.buffer_bytes = std::stoul(getSetting(argc, argv, "log-buffer-kb", "LOG_BUFFER_KB", "64")) * 1024;
+    Log::start(log_config);
+    if (!log_level_known) {
+        LOG_WARN("Unknown log level, using info", {{"level", log_level}});
+    }
+    
+    // HTTP-сервер: порт, потоки, очередь соединений, keep-alive и таймауты
+    // (параметр командной строки важнее переменной окружения)
+    std::string http_host = getSetting(argc, argv, "host", "HTTP_HOST", "0.0.0.0");
+    int http_port = std::stoi(getSetting(argc, argv, "port", "PORT", "8080"));
+    size_t default_threads = std::max<size_t>(8, std::thread::hardware_concurrency());
+    TaskQueueConfig queue_config;
+    queue_config.workers = std::stoul(getSetting(argc, argv, "threads", "HTTP_THREADS", std::to_string(default_threads)));
+    queue_config.max_queued = std::stoul(getSetting(argc, argv, "queue", "HTTP_QUEUE", std::to_string(queue_config.workers * 8)));
+    queue_config.max_rejecting = queue_config.max_queued;
+    size_t keep_alive_max = std::stoul(getSetting(argc, argv, "keep-alive-max", "HTTP_KEEP_ALIVE_MAX", "100"));
+    time_t keep_alive_timeout = std::stol(getSetting(argc, argv, "keep-alive-timeout", "HTTP_KEEP_ALIVE_TIMEOUT_SEC", "5"));
+    time_t read_timeout = std::stol(getSetting(argc, argv, "read-timeout", "HTTP_READ_TIMEOUT_SEC", "5"));
+    time_t write_timeout = std::stol(getSetting(argc, argv, "write-timeout", "HTTP_WRITE_TIMEOUT_SEC", "5"));
+    // /metrics - на отдельном адресе, по умолчанию доступном только с этой машины:
+    // маршруты, объем трафика и загрузка пулов не для клиентов API. 0 - не отдавать метрики
+    std::string metrics_host = getSetting(argc, argv, "metrics-host", "METRICS_HOST", "127.0.0.1");
+    int metrics_port = std::stoi(getSetting(argc, argv, "metrics-port", "METRICS_PORT", "9100"));
+    std::string retry_after = getSetting(argc, argv, "retry-after", "HTTP_RETRY_AFTER_SEC", "1");
+    
+    // Сжатие ответов API (gzip/zstd по Accept-Encoding)
+    CompressionConfig compression_config;
+    compression_config.enabled = getSetting(argc, argv, "compression", "HTTP_COMPRESSION", "1") != "0";
+    compression_config.min_bytes = std::stoul(getSetting(argc, argv, "compression-min-bytes", "HTTP_COMPRESSION_MIN_BYTES", "1024"));
+    compression_config.gzip_level = std::stoi(getSetting(argc, argv, "gzip-level", "HTTP_GZIP_LEVEL", "6"));
+    compression_config.zstd_level = std::stoi(getSetting(argc, argv, "zstd-level", "HTTP_ZSTD_LEVEL", "3"));
     
     // Подключение к базе данных (из переменных окружения или значения по умолчанию)
     std::string db_host = getEnvVar("DB_HOST", "localhost");
@@ -53,178 +306,374 @@ int main() {
                           " password=" + db_password + " host=" + db_host + 
                           " port=" + db_port;
     
-    std::cout << "Подключение к БД: " << db_host << ":" << db_port << "/" << db_name << std::endl;
+    LOG_INFO("Connecting to database", {{"host", db_host}, {"port", db_port}, {"db", db_name}});
+    
+    // Настройки пула соединений с БД
+    PoolConfig pool_config;
+    pool_config.min_size = std::stoul(getEnvVar("DB_POOL_MIN", "2"));
+    // По умолчанию соединений столько, сколько потоков обработки (+1 для группового коммита),
+    // чтобы поток никогда не ждал освободившееся соединение
+    pool_config.max_size = std::stoul(getEnvVar("DB_POOL_MAX", std::to_string(queue_config.workers + 1)));
+    pool_config.checkout_timeout = std::chrono::milliseconds(std::stol(getEnvVar("DB_POOL_TIMEOUT_MS", "5000")));
+    
+    // CACHE_ENABLED=0: без кэша в памяти, большие списки читаются из БД курсором
+    bool cache_enabled = getEnvVar("CACHE_ENABLED", "1") != "0";
+    
+    Database db(conn_str, pool_config, cache_enabled);
+    
+    // WRITE_BATCH=1: изменения из параллельных запросов коммитятся пакетами
+    if (getEnvVar("WRITE_BATCH", "0") != "0") {
+        WriteBatchConfig batch_config;
+        batch_config.window = std::chrono::microseconds(std::stol(getEnvVar("WRITE_BATCH_WINDOW_US", "2000")));
+        batch_config.max_ops = std::stoul(getEnvVar("WRITE_BATCH_MAX_OPS", "256"));
+        db.enableWriteBatching(batch_config);
+    }
     
-    Database db(conn_str);
+    // Хеширование паролей (scrypt) - в отдельных потоках с ограниченной очередью,
+    // чтобы волна входов не занимала все потоки обработки HTTP
+    PasswordHash::Params hash_params;
+    hash_params.n = std::stoull(getEnvVar("PASSWORD_SCRYPT_N", "16384"));
+    try {
+        PasswordHash::setParams(hash_params);
+    } catch (const std::invalid_argument& e) {
+        LOG_ERROR("Invalid PASSWORD_SCRYPT_N", {{"error", e.what()}});
+        Log::stop();
+        return 1;
+    }
+    HashingPoolConfig hashing_config;
+    hashing_config.workers = std::stoul(getEnvVar("PASSWORD_HASH_THREADS", "2"));
+    hashing_config.max_queued = std::stoul(getEnvVar("PASSWORD_HASH_QUEUE", std::to_string(hashing_config.workers * 2)));
+    db.enableHashingPool(hashing_config);
     
     // Создать тестового админа при первом запуске (если его еще нет)
     db.createDefaultAdmin();
     
+    // Обновлять кэш по изменениям, сделанным другими экземплярами сервера
+    if (cache_enabled && getEnvVar("CACHE_LISTEN", "1") != "0") {
+        db.startChangeListener();
+    }
+    
+    // Сессии пользователей: истекают после SESSION_TTL_SEC секунд простоя
+    SessionConfig session_config;
+    session_config.shards = std::stoul(getEnvVar("SESSION_SHARDS", "16"));
+    session_config.idle_ttl = std::chrono::seconds(std::stol(getEnvVar("SESSION_TTL_SEC", "1800")));
+    SessionStore sessions(session_config);
+    sessions.startSweeper();
+    
     httplib::Server svr;
     
-    // Статические файлы CSS и JS (путь относительно корня проекта)
-    svr.set_mount_point("/static", "./frontend");
+    // Соединения обрабатываются фиксированным числом потоков; при переполненной
+    // очереди клиент сразу получает 503 с Retry-After
+    std::atomic<BoundedTaskQueue*> http_queue{nullptr};
+    svr.new_task_queue = [&queue_config, &http_queue] {
+        auto* queue = new BoundedTaskQueue(queue_config);
+        http_queue = queue;
+        return queue;
+    };
+    svr.set_pre_routing_handler([retry_after](const httplib::Request& req, httplib::Response& res) {
+        if (!BoundedTaskQueue::isRejecting()) {
+            return httplib::Server::HandlerResponse::Unhandled;
+        }
+        res.status = 503;
+        res.set_header("Retry-After", retry_after);
+        res.set_header("Connection", "close");
+        res.set_content(R"({"error": "Сервер перегружен, повторите запрос позже"})", "application/json");
+        return httplib::Server::HandlerResponse::Handled;
+    });
+    // Готовые ответы сжимаются целиком после обработчика; потоковые сжимают себя сами
+    ResponseCompression compression(compression_config);
+    svr.set_post_routing_handler([&compression](const httplib::Request& req, httplib::Response& res) {
+        compression.compressBody(req, res);
+    });
+    svr.set_keep_alive_max_count(keep_alive_max);
+    svr.set_keep_alive_timeout(keep_alive_timeout);
+    svr.set_read_timeout(read_timeout, 0);
+    svr.set_write_timeout(write_timeout, 0);
+    
+    // Все маршруты регистрируются через routes: время и коды ответов попадают в /metrics
+    Routes routes(svr);
+    
+    // Файлы фронтенда: загружаются в память при старте вместе со сжатыми вариантами
+    // и отдаются с ETag и Cache-Control. STATIC_WATCH=1 (режим разработки) -
+    // перезагружать файлы при их изменении
+    StaticAssets static_assets(StaticAssets::resolveRoot(getSetting(argc, argv, "static-dir", "STATIC_DIR", "")),
+                               std::stol(getSetting(argc, argv, "static-max-age", "STATIC_MAX_AGE_SEC", "0")));
+    static_assets.load();
+    if (getSetting(argc, argv, "static-watch", "STATIC_WATCH", "0") != "0") {
+        static_assets.startWatcher();
+    }
+    
+    // Статические файлы CSS и JS
+    routes.Get(R"(/static/(.+))", [&static_assets](const httplib::Request& req, httplib::Response& res) {
+        static_assets.serve(req, res, req.matches[1]);
+    });
     
     // Главная страница
-    svr.Get("/", [](const httplib::Request& req, httplib::Response& res) {
-        std::string content = readFile("frontend/index.html");
-        if (content.empty()) {
-            content = readFile("./frontend/index.html");
-        }
-        res.set_content(content, "text/html");
+    routes.Get("/", [&static_assets](const httplib::Request& req, httplib::Response& res) {
+        static_assets.serve(req, res, "index.html");
     });
     
     // Страница входа
-    svr.Get("/login", [](const httplib::Request& req, httplib::Response& res) {
-        std::string content = readFile("frontend/login.html");
-        if (content.empty()) {
-            content = readFile("./frontend/login.html");
-        }
-        res.set_content(content, "text/html");
+    routes.Get("/login", [&static_assets](const httplib::Request& req, httplib::Response& res) {
+        static_assets.serve(req, res, "login.html");
     });
     
     // Страница регистрации
-    svr.Get("/register", [](const httplib::Request& req, httplib::Response& res) {
-        std::string content = readFile("frontend/register.html");
-        if (content.empty()) {
-            content = readFile("./frontend/register.html");
-        }
-        res.set_content(content, "text/html");
+    routes.Get("/register", [&static_assets](const httplib::Request& req, httplib::Response& res) {
+        static_assets.serve(req, res, "register.html");
     });
     
     // API: Регистрация
-    svr.Post("/api/register", [&db](const httplib::Request& req, httplib::Response& res) {
+    routes.Post("/api/register", [&db, retry_after](const httplib::Request& req, httplib::Response& res) {
         auto username = req.get_param_value("username");
         auto password = req.get_param_value("password");
         auto email = req.get_param_value("email");
         
-        std::cout << "Registration attempt - username: " << username 
-                  << ", email: " << email << std::endl;
+        LOG_DEBUG("Registration attempt", {{"user", username}, {"email", email}});
         
         if (username.empty() || password.empty() || email.empty()) {
-            std::cerr << "Registration failed: missing required fields" << std::endl;
+            LOG_INFO("Registration failed: missing required fields");
             res.set_content(R"({"success": false, "message": "Все поля обязательны"})", "application/json");
             return;
         }
         
-        if (db.registerUser(username, password, email)) {
-            std::cout << "Registration successful for: " << username << std::endl;
-            res.set_content(R"({"success": true, "message": "Регистрация успешна"})", "application/json");
-        } else {
-            std::cerr << "Registration failed for: " << username << " (user or email already exists)" << std::endl;
-            res.set_content(R"({"success": false, "message": "Пользователь с таким именем или email уже существует"})", "application/json");
+        switch (db.registerUser(username, password, email)) {
+            case RegisterResult::Created:
+                res.set_content(R"({"success": true, "message": "Регистрация успешна"})", "application/json");
+                break;
+            case RegisterResult::UsernameTaken:
+                res.set_content(R"({"success": false, "message": "Пользователь с таким именем уже существует"})", "application/json");
+                break;
+            case RegisterResult::EmailTaken:
+                res.set_content(R"({"success": false, "message": "Пользователь с таким email уже существует"})", "application/json");
+                break;
+            case RegisterResult::Taken:
+                res.set_content(R"({"success": false, "message": "Пользователь с таким именем или email уже существует"})", "application/json");
+                break;
+            case RegisterResult::Overloaded:
+                res.status = 503;
+                res.set_header("Retry-After", retry_after);
+                res.set_content(R"({"success": false, "message": "Сервер перегружен, повторите попытку позже"})", "application/json");
+                break;
+            case RegisterResult::Error:
+                res.status = 500;
+                res.set_content(R"({"success": false, "message": "Ошибка сервера"})", "application/json");
+                break;
         }
     });
     
     // API: Вход
-    svr.Post("/api/login", [&db](const httplib::Request& req, httplib::Response& res) {
+    routes.Post("/api/login", [&db, &sessions, retry_after](const httplib::Request& req, httplib::Response& res) {
         auto username = req.get_param_value("username");
         auto password = req.get_param_value("password");
         
-        std::cout << "Login attempt - username: " << username << ", password length: " << password.length() << std::endl;
+        LOG_DEBUG("Login attempt", {{"user", username}});
         
         if (username.empty() || password.empty()) {
-            std::cerr << "Login failed: empty username or password" << std::endl;
+            LOG_INFO("Login failed: empty username or password");
             res.set_content(R"({"success": false, "message": "Логин и пароль обязательны"})", "application/json");
             return;
         }
         
-        User* user = db.authenticateUser(username, password);
+        bool overloaded = false;
+        auto user = db.authenticateUser(username, password, overloaded);
+        if (overloaded) {
+            res.status = 503;
+            res.set_header("Retry-After", retry_after);
+            res.set_content(R"({"success": false, "message": "Сервер перегружен, повторите попытку позже"})", "application/json");
+            return;
+        }
         if (user) {
-            std::string session_id = generateSessionId();
-            sessions[session_id] = user;
+            std::string session_id;
+            try {
+                session_id = sessions.create(*user, Permissions::forRole(user->role));
+            } catch (const std::exception& e) {
+                LOG_ERROR("Login failed: session error", {{"user", username}, {"error", e.what()}});
+                res.status = 500;
+                res.set_content(R"({"success": false, "message": "Ошибка сервера"})", "application/json");
+                return;
+            }
             
-            std::cout << "Login successful for: " << username << " (role: " << user->role << "), session_id: " << session_id << std::endl;
+            LOG_INFO("Login successful", {{"user", username}, {"role", user->role}});
             
-            std::string response = "{\"success\": true, \"session_id\": \"" + session_id + 
-                                  "\", \"role\": \"" + user->role + "\"}";
-            res.set_content(response, "application/json");
+            JsonWriter json;
+            json.beginObject()
+                .field("success", true)
+                .field("session_id", session_id)
+                .field("role", user->role)
+                .endObject();
+            res.set_content(json.take(), "application/json");
         } else {
-            std::cerr << "Login failed for: " << username << " (invalid credentials)" << std::endl;
+            LOG_INFO("Login failed: invalid credentials", {{"user", username}});
             res.set_content(R"({"success": false, "message": "Неверный логин или пароль"})", "application/json");
         }
     });
     
-    // API: Получить всех студентов
-    svr.Get("/api/students", [&db, &sessions](const httplib::Request& req, httplib::Response& res) {
+    // API: Получить студентов (весь список или страницу: limit, after_id, group_name)
+    routes.Get("/api/students", [&db, &sessions, &compression](const httplib::Request& req, httplib::Response& res) {
         auto session_id = req.get_param_value("session_id");
         
-        if (sessions.find(session_id) == sessions.end()) {
+        if (!sessions.authorize(session_id, Permissions::VIEW_DATA)) {
             res.status = 401;
             res.set_content(R"({"error": "Не авторизован"})", "application/json");
             return;
         }
         
-        auto students = db.getAllStudents();
-        std::string json = "[";
-        for (size_t i = 0; i < students.size(); i++) {
-            json += "{";
-            json += "\"id\": " + std::to_string(students[i].id) + ",";
-            json += "\"name\": \"" + students[i].name + "\",";
-            json += "\"surname\": \"" + students[i].surname + "\",";
-            json += "\"group_name\": \"" + students[i].group_name + "\"";
-            json += "}";
-            if (i < students.size() - 1) json += ",";
+        if (notModified(req, res, dataETag(db))) {
+            return;
+        }
+        
+        // Без параметров - весь список потоком (как раньше), иначе - одна страница
+        if (!isPageRequest(req, {"limit", "after_id", "group_name"})) {
+            streamJsonArray<Student>(req, res, compression, [&db](const std::function<bool(const Student&)>& visit) {
+                return db.forEachStudent(visit);
+            });
+            return;
+        }
+        
+        StudentPageQuery query;
+        long after_id = 0;
+        if (!readIntParam(req, "limit", 1, MAX_PAGE_LIMIT, DEFAULT_PAGE_LIMIT, query.limit) ||
+            !readIntParam(req, "after_id", 0, INT32_MAX, 0, after_id)) {
+            res.status = 400;
+            res.set_content(R"({"error": "Неверные параметры страницы"})", "application/json");
+            return;
+        }
+        query.after_id = (int)after_id;
+        query.group_name = req.get_param_value("group_name");
+        
+        std::vector<Student> page;
+        bool has_more = false;
+        if (!db.getStudentsPage(query, page, has_more)) {
+            res.status = 500;
+            res.set_content(R"({"error": "Ошибка базы данных"})", "application/json");
+            return;
         }
-        json += "]";
-        res.set_content(json, "application/json");
+        sendPage(res, page, has_more);
     });
     
     // API: Прогноз для студента
-    svr.Get("/api/predict", [&db, &sessions](const httplib::Request& req, httplib::Response& res) {
+    routes.Get("/api/predict", [&db, &sessions](const httplib::Request& req, httplib::Response& res) {
         auto session_id = req.get_param_value("session_id");
         auto student_id_str = req.get_param_value("student_id");
         
-        if (sessions.find(session_id) == sessions.end()) {
+        if (!sessions.authorize(session_id, Permissions::VIEW_DATA)) {
             res.status = 401;
             res.set_content(R"({"error": "Не авторизован"})", "application/json");
             return;
         }
         
+        if (notModified(req, res, dataETag(db))) {
+            return;
+        }
+        
         int student_id = std::stoi(student_id_str);
         std::string prediction = db.predictExamSuccess(student_id);
-        res.set_content("{\"prediction\": \"" + prediction + "\"}", "application/json");
+        JsonWriter json;
+        json.beginObject().field("prediction", prediction).endObject();
+        res.set_content(json.take(), "application/json");
     });
     
-    // API: Получить все оценки
-    svr.Get("/api/grades", [&db, &sessions](const httplib::Request& req, httplib::Response& res) {
+    // API: Прогноз сразу для нескольких студентов
+    // ids=1,2,3 - по списку, group_name=... - по группе, без параметров - все студенты
+    routes.Get("/api/predict/batch", [&db, &sessions](const httplib::Request& req, httplib::Response& res) {
         auto session_id = req.get_param_value("session_id");
         
-        if (sessions.find(session_id) == sessions.end()) {
+        if (!sessions.authorize(session_id, Permissions::VIEW_DATA)) {
             res.status = 401;
             res.set_content(R"({"error": "Не авторизован"})", "application/json");
             return;
         }
         
-        auto grades = db.getAllGrades();
-        std::string json = "[";
-        for (size_t i = 0; i < grades.size(); i++) {
-            json += "{";
-            json += "\"id\": " + std::to_string(grades[i].id) + ",";
-            json += "\"student_id\": " + std::to_string(grades[i].student_id) + ",";
-            json += "\"subject\": \"" + grades[i].subject + "\",";
-            json += "\"grade\": " + std::to_string(grades[i].grade) + ",";
-            json += "\"semester\": " + std::to_string(grades[i].semester) + ",";
-            json += "\"attendance_percent\": " + std::to_string(grades[i].attendance_percent) + ",";
-            json += "\"assignment_completion\": " + std::to_string(grades[i].assignment_completion) + ",";
-            json += "\"exam_result\": " + std::to_string(grades[i].exam_result);
-            json += "}";
-            if (i < grades.size() - 1) json += ",";
-        }
-        json += "]";
-        res.set_content(json, "application/json");
+        if (notModified(req, res, dataETag(db))) {
+            return;
+        }
+        
+        std::vector<Prediction> predictions;
+        if (req.has_param("ids")) {
+            std::vector<int> ids;
+            std::stringstream ss(req.get_param_value("ids"));
+            std::string item;
+            while (std::getline(ss, item, ',')) {
+                if (item.empty()) {
+                    continue;
+                }
+                // Число целиком и в пределах int: "12abc" и переполнение - ошибка, а не 12
+                int id = 0;
+                auto parsed = std::from_chars(item.data(), item.data() + item.size(), id);
+                if (parsed.ec != std::errc() || parsed.ptr != item.data() + item.size()) {
+                    res.status = 400;
+                    res.set_content(R"({"error": "Неверный список ids"})", "application/json");
+                    return;
+                }
+                ids.push_back(id);
+            }
+            if (!ids.empty()) {
+                predictions = db.predictBatch(ids);
+            }
+        } else if (req.has_param("group_name")) {
+            predictions = db.predictGroup(req.get_param_value("group_name"));
+        } else {
+            predictions = db.predictBatch({});
+        }
+        
+        JsonWriter json(64 + predictions.size() * 128);
+        json.beginObject().key("predictions");
+        ApiJson::writeArray(json, predictions);
+        json.endObject();
+        res.set_content(json.take(), "application/json");
     });
     
-    // Админ API: Добавить студента
-    svr.Post("/api/admin/students/add", [&db, &sessions](const httplib::Request& req, httplib::Response& res) {
+    // API: Получить оценки (все или страницу: limit, after_id, student_id, subject, semester)
+    routes.Get("/api/grades", [&db, &sessions, &compression](const httplib::Request& req, httplib::Response& res) {
         auto session_id = req.get_param_value("session_id");
         
-        if (sessions.find(session_id) == sessions.end() || sessions[session_id]->role != "admin") {
-            res.status = 403;
-            res.set_content(R"({"error": "Доступ запрещен"})", "application/json");
+        if (!sessions.authorize(session_id, Permissions::VIEW_DATA)) {
+            res.status = 401;
+            res.set_content(R"({"error": "Не авторизован"})", "application/json");
+            return;
+        }
+        
+        if (notModified(req, res, dataETag(db))) {
+            return;
+        }
+        
+        if (!isPageRequest(req, {"limit", "after_id", "student_id", "subject", "semester"})) {
+            streamJsonArray<Grade>(req, res, compression, [&db](const std::function<bool(const Grade&)>& visit) {
+                return db.forEachGrade(visit);
+            });
+            return;
+        }
+        
+        GradePageQuery query;
+        long after_id = 0;
+        long student_id = 0;
+        long semester = 0;
+        if (!readIntParam(req, "limit", 1, MAX_PAGE_LIMIT, DEFAULT_PAGE_LIMIT, query.limit) ||
+            !readIntParam(req, "after_id", 0, INT32_MAX, 0, after_id) ||
+            !readIntParam(req, "student_id", 1, INT32_MAX, 0, student_id) ||
+            !readIntParam(req, "semester", 1, INT32_MAX, 0, semester)) {
+            res.status = 400;
+            res.set_content(R"({"error": "Неверные параметры страницы"})", "application/json");
             return;
         }
+        query.after_id = (int)after_id;
+        query.student_id = (int)student_id;
+        query.semester = (int)semester;
+        query.subject = req.get_param_value("subject");
         
+        std::vector<Grade> page;
+        bool has_more = false;
+        if (!db.getGradesPage(query, page, has_more)) {
+            res.status = 500;
+            res.set_content(R"({"error": "Ошибка базы данных"})", "application/json");
+            return;
+        }
+        sendPage(res, page, has_more);
+    });
+    
+    // Админ API: Добавить студента
+    routes.Post("/api/admin/students/add", guarded(sessions, Permissions::MANAGE_STUDENTS, [&db](const httplib::Request& req, httplib::Response& res) {
         auto name = req.get_param_value("name");
         auto surname = req.get_param_value("surname");
         auto group_name = req.get_param_value("group_name");
@@ -234,18 +683,10 @@ int main() {
         } else {
             res.set_content(R"({"success": false})", "application/json");
         }
-    });
+    }));
     
     // Админ API: Обновить студента
-    svr.Post("/api/admin/students/update", [&db, &sessions](const httplib::Request& req, httplib::Response& res) {
-        auto session_id = req.get_param_value("session_id");
-        
-        if (sessions.find(session_id) == sessions.end() || sessions[session_id]->role != "admin") {
-            res.status = 403;
-            res.set_content(R"({"error": "Доступ запрещен"})", "application/json");
-            return;
-        }
-        
+    routes.Post("/api/admin/students/update", guarded(sessions, Permissions::MANAGE_STUDENTS, [&db](const httplib::Request& req, httplib::Response& res) {
         int id = std::stoi(req.get_param_value("id"));
         auto name = req.get_param_value("name");
         auto surname = req.get_param_value("surname");
@@ -256,18 +697,10 @@ int main() {
         } else {
             res.set_content(R"({"success": false})", "application/json");
         }
-    });
+    }));
     
     // Админ API: Удалить студента
-    svr.Post("/api/admin/students/delete", [&db, &sessions](const httplib::Request& req, httplib::Response& res) {
-        auto session_id = req.get_param_value("session_id");
-        
-        if (sessions.find(session_id) == sessions.end() || sessions[session_id]->role != "admin") {
-            res.status = 403;
-            res.set_content(R"({"error": "Доступ запрещен"})", "application/json");
-            return;
-        }
-        
+    routes.Post("/api/admin/students/delete", guarded(sessions, Permissions::MANAGE_STUDENTS, [&db](const httplib::Request& req, httplib::Response& res) {
         int id = std::stoi(req.get_param_value("id"));
         
         if (db.deleteStudent(id)) {
@@ -275,18 +708,10 @@ int main() {
         } else {
             res.set_content(R"({"success": false})", "application/json");
         }
-    });
+    }));
     
     // Админ API: Добавить оценку
-    svr.Post("/api/admin/grades/add", [&db, &sessions](const httplib::Request& req, httplib::Response& res) {
-        auto session_id = req.get_param_value("session_id");
-        
-        if (sessions.find(session_id) == sessions.end() || sessions[session_id]->role != "admin") {
-            res.status = 403;
-            res.set_content(R"({"error": "Доступ запрещен"})", "application/json");
-            return;
-        }
-        
+    routes.Post("/api/admin/grades/add", guarded(sessions, Permissions::MANAGE_GRADES, [&db](const httplib::Request& req, httplib::Response& res) {
         int student_id = std::stoi(req.get_param_value("student_id"));
         auto subject = req.get_param_value("subject");
         int grade = std::stoi(req.get_param_value("grade"));
@@ -300,18 +725,10 @@ int main() {
         } else {
             res.set_content(R"({"success": false})", "application/json");
         }
-    });
+    }));
     
     // Админ API: Обновить оценку
-    svr.Post("/api/admin/grades/update", [&db, &sessions](const httplib::Request& req, httplib::Response& res) {
-        auto session_id = req.get_param_value("session_id");
-        
-        if (sessions.find(session_id) == sessions.end() || sessions[session_id]->role != "admin") {
-            res.status = 403;
-            res.set_content(R"({"error": "Доступ запрещен"})", "application/json");
-            return;
-        }
-        
+    routes.Post("/api/admin/grades/update", guarded(sessions, Permissions::MANAGE_GRADES, [&db](const httplib::Request& req, httplib::Response& res) {
         int id = std::stoi(req.get_param_value("id"));
         int student_id = std::stoi(req.get_param_value("student_id"));
         auto subject = req.get_param_value("subject");
@@ -326,18 +743,10 @@ int main() {
         } else {
             res.set_content(R"({"success": false})", "application/json");
         }
-    });
+    }));
     
     // Админ API: Удалить оценку
-    svr.Post("/api/admin/grades/delete", [&db, &sessions](const httplib::Request& req, httplib::Response& res) {
-        auto session_id = req.get_param_value("session_id");
-        
-        if (sessions.find(session_id) == sessions.end() || sessions[session_id]->role != "admin") {
-            res.status = 403;
-            res.set_content(R"({"error": "Доступ запрещен"})", "application/json");
-            return;
-        }
-        
+    routes.Post("/api/admin/grades/delete", guarded(sessions, Permissions::MANAGE_GRADES, [&db](const httplib::Request& req, httplib::Response& res) {
         int id = std::stoi(req.get_param_value("id"));
         
         if (db.deleteGrade(id)) {
@@ -345,11 +754,226 @@ int main() {
         } else {
             res.set_content(R"({"success": false})", "application/json");
         }
+    }));
+    
+    // Выгрузка всей таблицы оценок для анализа: ?format=csv (по умолчанию) или format=binary
+    // (столбцовый формат для mmap, см. grade_export.h). Читается из БД через COPY и
+    // отдается частями, память не зависит от размера таблицы
+    routes.Get("/api/export", guarded(sessions, Permissions::EXPORT_DATA, [&db, &compression](const httplib::Request& req, httplib::Response& res) {
+        ExportFormat format;
+        if (!GradeExport::parseFormat(req.get_param_value("format"), format)) {
+            res.status = 400;
+            res.set_content(R"({"error": "Укажите format=csv или format=binary"})", "application/json");
+            return;
+        }
+        
+        if (format == ExportFormat::Csv) {
+            res.set_header("Content-Disposition", "attachment; filename=\"grades.csv\"");
+            compression.setChunkedContent(req, res, "text/csv; charset=utf-8", [&db](const ResponseCompression::ChunkWriter& write) {
+                std::string buffer;
+                buffer.reserve(STREAM_CHUNK_BYTES + 1024);
+                GradeExport::writeCsvHeader(buffer);
+                bool client_alive = true;
+                bool ok = db.exportGrades([&](const Grade& grade, GradeExport::Nulls::Mask nulls) {
+                    GradeExport::writeCsvRow(buffer, grade, nulls);
+                    if (buffer.size() >= STREAM_CHUNK_BYTES) {
+                        client_alive = write(buffer.data(), buffer.size());
+                        buffer.clear();
+                    }
+                    return client_alive;
+                });
+                if (!ok || !client_alive) {
+                    return false;   // Оборвать ответ: неполный файл не должен выглядеть полным
+                }
+                return write(buffer.data(), buffer.size());
+            });
+            return;
+        }
+        
+        res.set_header("Content-Disposition", "attachment; filename=\"grades.bin\"");
+        compression.setChunkedContent(req, res, "application/octet-stream", [&db](const ResponseCompression::ChunkWriter& write) {
+            GradeColumnarWriter writer;
+            std::string buffer;
+            GradeColumnarWriter::writeFileHeader(buffer);
+            bool client_alive = true;
+            bool ok = db.exportGrades([&](const Grade& grade, GradeExport::Nulls::Mask nulls) {
+                writer.add(grade, nulls);
+                if (writer.full()) {
+                    writer.flushBlock(buffer);
+                    client_alive = write(buffer.data(), buffer.size());
+                    buffer.clear();
+                }
+                return client_alive;
+            });
+            if (!ok || !client_alive) {
+                return false;
+            }
+            writer.flushBlock(buffer);
+            GradeColumnarWriter::writeFileTrailer(buffer);
+            return write(buffer.data(), buffer.size());
+        });
+    }));
+    
+    // Админ API: Массовый импорт оценок (тело - CSV или NDJSON, читается потоком).
+    // ?format=csv|ndjson (или по Content-Type), &skip_invalid=1 - загрузить корректные строки,
+    // даже если в других есть ошибки (по умолчанию - все или ничего)
+    routes.Post("/api/admin/grades/import", guarded(sessions, Permissions::MANAGE_GRADES,
+             [&db](const httplib::Request& req, httplib::Response& res, const httplib::ContentReader& content_reader) {
+        ImportFormat format;
+        std::string format_name = req.has_param("format") ? req.get_param_value("format")
+                                                          : req.get_header_value("Content-Type");
+        if (!GradeImportParser::parseFormat(format_name, format)) {
+            res.status = 400;
+            res.set_content(R"({"error": "Укажите format=csv или format=ndjson"})", "application/json");
+            return;
+        }
+        bool skip_invalid = req.get_param_value("skip_invalid") == "1";
+        
+        ImportReport report = db.importGrades(format, skip_invalid,
+            [&content_reader](const std::function<bool(const char*, size_t)>& receiver) {
+                return content_reader([&receiver](const char* data, size_t size) {
+                    return receiver(data, size);
+                });
+            });
+        
+        if (!report.committed) {
+            res.status = report.failure.empty() ? 422 : 500;
+        }
+        JsonWriter json(256 + report.errors.size() * 96);
+        json.beginObject()
+            .field("success", report.committed)
+            .field("rows", report.rows)
+            .field("imported", report.imported)
+            .field("error_count", report.error_count);
+        if (!report.failure.empty()) {
+            json.field("failure", report.failure);
+        }
+        json.key("errors").beginArray();
+        for (const auto& error : report.errors) {
+            json.beginObject().field("line", error.line).field("error", error.message).endObject();
+        }
+        json.endArray().endObject();
+        res.set_content(json.take(), "application/json");
+    }));
+    
+    // Админ API: Счетчики пула соединений с БД
+    routes.Get("/api/admin/pool", guarded(sessions, Permissions::VIEW_SERVER_STATS, [&db, &http_queue, &compression](const httplib::Request& req, httplib::Response& res) {
+        PoolStats stats = db.getPoolStats();
+        JsonWriter json;
+        json.beginObject()
+            .field("total", stats.total)
+            .field("idle", stats.idle)
+            .field("in_use", stats.in_use)
+            .field("checkouts", stats.checkouts)
+            .field("waits", stats.waits)
+            .field("wait_time_us", stats.wait_time_us)
+            .field("timeouts", stats.timeouts)
+            .field("reconnects", stats.reconnects);
+        WriteBatchStats batch = db.getWriteBatchStats();
+        json.key("write_batch").beginObject()
+            .field("batches", batch.batches)
+            .field("operations", batch.operations)
+            .field("failed", batch.failed)
+            .endObject();
+        if (BoundedTaskQueue* queue = http_queue.load()) {
+            TaskQueueStats http = queue->stats();
+            json.key("http").beginObject()
+                .field("workers", http.workers)
+                .field("busy", http.busy)
+                .field("queued", http.queued)
+                .field("accepted", http.accepted)
+                .field("rejected", http.rejected)
+                .field("dropped", http.dropped)
+                .endObject();
+        }
+        HashingPoolStats hashing = db.getHashingStats();
+        json.key("hashing").beginObject()
+            .field("workers", hashing.workers)
+            .field("busy", hashing.busy)
+            .field("queued", hashing.queued)
+            .field("completed", hashing.completed)
+            .field("rejected", hashing.rejected)
+            .field("wait_time_us", hashing.wait_time_us)
+            .endObject();
+        CompressionStats compressed = compression.stats();
+        json.key("compression").beginObject()
+            .field("responses", compressed.responses)
+            .field("gzip", compressed.gzip)
+            .field("zstd", compressed.zstd)
+            .field("identity_bytes", compressed.identity_bytes)
+            .field("compressed_bytes", compressed.compressed_bytes)
+            .endObject();
+        json.endObject();
+        res.set_content(json.take(), "application/json");
+    }));
+    
+    // Метрики в формате Prometheus: маршруты, запросы к БД, соединения и счетчики пулов.
+    // Отдельный сервер с одним потоком: опрос метрик не занимает потоки API
+    httplib::Server metrics_svr;
+    metrics_svr.new_task_queue = [] { return new httplib::ThreadPool(1); };
+    Routes metrics_routes(metrics_svr);
+    metrics_routes.Get("/metrics", [&db, &http_queue, &compression](const httplib::Request& req, httplib::Response& res) {
+        std::string out;
+        out.reserve(64 * 1024);
+        Metrics::render(out);
+        
+        PoolStats pool = db.getPoolStats();
+        Metrics::writeSample(out, "db_pool_connections", "gauge", "Открытых соединений с БД", pool.total);
+        Metrics::writeSample(out, "db_pool_connections_in_use", "gauge", "Выданных соединений", pool.in_use);
+        Metrics::writeSample(out, "db_pool_checkouts_total", "counter", "Выдач соединений", pool.checkouts);
+        Metrics::writeSample(out, "db_pool_waits_total", "counter", "Выдач, которым пришлось ждать", pool.waits);
+        Metrics::writeSample(out, "db_pool_timeouts_total", "counter", "Выдач, не дождавшихся соединения", pool.timeouts);
+        if (BoundedTaskQueue* queue = http_queue.load()) {
+            TaskQueueStats http = queue->stats();
+            Metrics::writeSample(out, "http_workers_busy", "gauge", "Потоков, занятых соединением", http.busy);
+            Metrics::writeSample(out, "http_queue_length", "gauge", "Соединений в очереди", http.queued);
+            Metrics::writeSample(out, "http_rejected_total", "counter", "Соединений, получивших 503", http.rejected);
+            Metrics::writeSample(out, "http_dropped_total", "counter", "Соединений, закрытых без ответа", http.dropped);
+        }
+        HashingPoolStats hashing = db.getHashingStats();
+        Metrics::writeSample(out, "password_hash_total", "counter", "Посчитано хешей паролей", hashing.completed);
+        Metrics::writeSample(out, "password_hash_rejected_total", "counter", "Хешей, отклоненных из-за очереди", hashing.rejected);
+        CompressionStats compressed = compression.stats();
+        Metrics::writeSample(out, "http_compressed_responses_total", "counter", "Сжатых ответов", compressed.responses);
+        Metrics::writeSample(out, "http_compression_input_bytes_total", "counter", "Байт сжатых ответов до сжатия", compressed.identity_bytes);
+        Metrics::writeSample(out, "http_compression_output_bytes_total", "counter", "Байт сжатых ответов после сжатия", compressed.compressed_bytes);
+        Log::Stats log = Log::stats();
+        Metrics::writeSample(out, "log_records_total", "counter", "Выведено записей журнала", log.written);
+        Metrics::writeSample(out, "log_dropped_total", "counter", "Записей журнала, отброшенных из-за заполненного буфера", log.dropped);
+        Metrics::writeSample(out, "log_suppressed_total", "counter", "Записей журнала, пропущенных ограничением частоты", log.suppressed);
+        
+        res.set_content(out, "text/plain; version=0.0.4; charset=utf-8");
     });
     
-    std::cout << "Server started on http://localhost:8080" << std::endl;
-    svr.listen("0.0.0.0", 8080);
+    std::thread metrics_thread;
+    if (metrics_port > 0) {
+        if (!metrics_svr.bind_to_port(metrics_host, metrics_port)) {
+            LOG_ERROR("Failed to start metrics listener", {{"host", metrics_host}, {"port", metrics_port}});
+            Log::stop();
+            return 1;
+        }
+        metrics_thread = std::thread([&metrics_svr] { metrics_svr.listen_after_bind(); });
+        metrics_svr.wait_until_ready();    // Иначе stop() до начала приема не остановит поток
+        LOG_INFO("Metrics listener started", {{"host", metrics_host}, {"port", metrics_port}});
+    }
+    auto stopMetrics = [&metrics_svr, &metrics_thread] {
+        if (metrics_thread.joinable()) {
+            metrics_svr.stop();
+            metrics_thread.join();
+        }
+    };
+    
+    LOG_INFO("Server started", {{"host", http_host}, {"port", http_port}, {"threads", queue_config.workers},
+                                {"queue", queue_config.max_queued}, {"db_pool", pool_config.max_size}});
+    if (!svr.listen(http_host, http_port)) {
+        LOG_ERROR("Failed to start server", {{"host", http_host}, {"port", http_port}});
+        stopMetrics();
+        Log::stop();
+        return 1;
+    }
     
+    stopMetrics();
+    Log::stop();
     return 0;
 }
 
@@ -0,0 +1,178 @@
+#include "session_store.h"
+#include "log.h"
+#include <openssl/rand.h>
+#include <stdexcept>
+#include <functional>
+
+namespace {
+    size_t roundUpToPowerOfTwo(size_t n) {
+        size_t result = 1;
+        while (result < n) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // Номер части из старших бит хэша: младшие unordered_map использует для выбора корзины
+    // внутри части. Хэш умножается в 64 битах (фибоначчиево хэширование), поэтому старшие
+    // биты перемешаны и при 32-битном size_t
+    size_t shardBits(const std::string& session_id) {
+        uint64_t hash = std::hash<std::string>()(session_id);
+        return (size_t)((hash * 0x9E3779B97F4A7C15ull) >> 32);
+    }
+}
+
+SessionStore::SessionStore(const SessionConfig& config)
+    : config(config), shards(roundUpToPowerOfTwo(config.shards == 0 ? 1 : config.shards)),
+      shard_mask(shards.size() - 1) {}
+
+SessionStore::~SessionStore() {
+    stopSweeper();
+}
+
+int64_t SessionStore::nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+SessionStore::Shard& SessionStore::shardFor(const std::string& session_id) {
+    return shards[shardBits(session_id) & shard_mask];
+}
+
+const SessionStore::Shard& SessionStore::shardFor(const std::string& session_id) const {
+    return shards[shardBits(session_id) & shard_mask];
+}
+
+std::string SessionStore::generateId() {
+    unsigned char bytes[16];
+    if (RAND_bytes(bytes, sizeof(bytes)) != 1) {
+        throw std::runtime_error("RAND_bytes failed");
+    }
+    static const char hex[] = "0123456789abcdef";
+    std::string id(sizeof(bytes) * 2, '0');
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        id[2 * i] = hex[bytes[i] >> 4];
+        id[2 * i + 1] = hex[bytes[i] & 0xF];
+    }
+    return id;
+}
+
+std::string SessionStore::create(const User& user, Permissions::Mask permissions) {
+    int64_t now = nowMs();
+    while (true) {
+        std::string id = generateId();
+        Shard& shard = shardFor(id);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        // Совпадение 128-битных идентификаторов практически невозможно, но проверить дешево
+        if (shard.sessions.emplace(id, std::make_unique<Entry>(user, permissions, now)).second) {
+            return id;
+        }
+    }
+}
+
+SessionStore::Entry* SessionStore::touch(const Shard& shard, const std::string& session_id) const {
+    auto it = shard.sessions.find(session_id);
+    if (it == shard.sessions.end()) {
+        return nullptr;
+    }
+
+    Entry& entry = *it->second;
+    int64_t now = nowMs();
+    int64_t ttl_ms = std::chrono::duration_cast<std::chrono::milliseconds>(config.idle_ttl).count();
+    if (now - entry.last_access_ms.load(std::memory_order_relaxed) > ttl_ms) {
+        // Истекла; удалит фоновая очистка
+        return nullptr;
+    }
+    entry.last_access_ms.store(now, std::memory_order_relaxed);
+    return &entry;
+}
+
+std::optional<User> SessionStore::find(const std::string& session_id) const {
+    if (session_id.empty()) {
+        return std::nullopt;
+    }
+    const Shard& shard = shardFor(session_id);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    Entry* entry = touch(shard, session_id);
+    if (!entry) {
+        return std::nullopt;
+    }
+    return entry->user;
+}
+
+bool SessionStore::authorize(const std::string& session_id, Permissions::Mask required) const {
+    if (session_id.empty()) {
+        return false;
+    }
+    const Shard& shard = shardFor(session_id);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    Entry* entry = touch(shard, session_id);
+    return entry && Permissions::allows(entry->permissions, required);
+}
+
+bool SessionStore::remove(const std::string& session_id) {
+    Shard& shard = shardFor(session_id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.sessions.erase(session_id) > 0;
+}
+
+size_t SessionStore::sweep() {
+    int64_t now = nowMs();
+    int64_t ttl_ms = std::chrono::duration_cast<std::chrono::milliseconds>(config.idle_ttl).count();
+    size_t removed = 0;
+    for (auto& shard : shards) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        for (auto it = shard.sessions.begin(); it != shard.sessions.end();) {
+            if (now - it->second->last_access_ms.load(std::memory_order_relaxed) > ttl_ms) {
+                it = shard.sessions.erase(it);
+                removed++;
+            } else {
+                ++it;
+            }
+        }
+    }
+    return removed;
+}
+
+size_t SessionStore::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        total += shard.sessions.size();
+    }
+    return total;
+}
+
+void SessionStore::startSweeper() {
+    if (running.exchange(true)) {
+        return;
+    }
+    sweeper = std::thread(&SessionStore::sweepLoop, this);
+}
+
+void SessionStore::stopSweeper() {
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex);
+        running = false;
+    }
+    stop_cv.notify_all();
+    if (sweeper.joinable()) {
+        sweeper.join();
+    }
+}
+
+void SessionStore::sweepLoop() {
+    while (running) {
+        {
+            std::unique_lock<std::mutex> lock(stop_mutex);
+            stop_cv.wait_for(lock, config.sweep_interval, [this] { return !running; });
+        }
+        if (!running) {
+            break;
+        }
+        size_t removed = sweep();
+        if (removed > 0) {
+            LOG_DEBUG("Session store: expired sessions removed", {{"removed", removed}});
+        }
+    }
+}
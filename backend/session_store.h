@@ -0,0 +1,102 @@
+#ifndef SESSION_STORE_H
+#define SESSION_STORE_H
+
+#include "models.h"
+#include "permissions.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// Настройки хранилища сессий
+struct SessionConfig {
+    size_t shards = 16;                                     // Число независимых частей (округляется до степени двойки)
+    std::chrono::seconds idle_ttl{30 * 60};                 // Сессия удаляется после такого простоя
+    std::chrono::seconds sweep_interval{60};                // Период фоновой очистки
+};
+
+// Потокобезопасное хранилище сессий.
+// Сессии разбиты на части по идентификатору; у каждой части свой shared_mutex,
+// поэтому поиск (самая частая операция - ее делает каждый обработчик API) идет
+// под разделяемой блокировкой одной части и не мешает потокам на других ядрах.
+// Время последнего обращения обновляется атомарно, без исключительной блокировки.
+// Идентификатор сессии - 128 случайных бит из RAND_bytes (32 hex-символа).
+class SessionStore {
+private:
+    struct Entry {
+        User user;
+        Permissions::Mask permissions;
+        std::atomic<int64_t> last_access_ms;
+
+        Entry(const User& user, Permissions::Mask permissions, int64_t now_ms)
+            : user(user), permissions(permissions), last_access_ms(now_ms) {}
+    };
+
+    // Каждая часть на своей кэш-линии, чтобы блокировки соседних частей не делили линию
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, std::unique_ptr<Entry>> sessions;
+    };
+
+    SessionConfig config;
+    std::vector<Shard> shards;
+    size_t shard_mask;
+
+    std::thread sweeper;
+    std::atomic<bool> running{false};
+    std::mutex stop_mutex;
+    std::condition_variable stop_cv;
+
+    Shard& shardFor(const std::string& session_id);
+    const Shard& shardFor(const std::string& session_id) const;
+
+    // Живая запись сессии с продленным сроком или nullptr; вызывать под блокировкой части
+    Entry* touch(const Shard& shard, const std::string& session_id) const;
+    void sweepLoop();
+
+    static int64_t nowMs();
+
+public:
+    explicit SessionStore(const SessionConfig& config = SessionConfig());
+    ~SessionStore();
+
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+    // Создать сессию для пользователя с правами permissions; возвращает ее идентификатор.
+    // Бросает std::runtime_error, если не удалось получить случайные байты
+    std::string create(const User& user, Permissions::Mask permissions);
+
+    // Пользователь сессии (и продление ее срока) или nullopt, если сессии нет или она истекла
+    std::optional<User> find(const std::string& session_id) const;
+
+    // Есть ли у сессии все права из required (и продление ее срока).
+    // Не копирует пользователя - это проверка, которую делает каждый обработчик API
+    bool authorize(const std::string& session_id, Permissions::Mask required) const;
+
+    // Завершить сессию
+    bool remove(const std::string& session_id);
+
+    // Удалить все истекшие сессии; возвращает число удаленных
+    size_t sweep();
+
+    size_t size() const;
+
+    // Фоновая очистка истекших сессий раз в sweep_interval
+    void startSweeper();
+    void stopSweeper();
+
+    // 128-битный случайный идентификатор в hex
+    static std::string generateId();
+};
+
+#endif
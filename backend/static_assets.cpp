@@ -0,0 +1,311 @@
+#include "static_assets.h"
+#include "response_compression.h"
+#include "log.h"
+#include <zlib.h>
+#include <brotli/encode.h>
+#include <openssl/sha.h>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    std::string contentTypeFor(const std::string& path) {
+        std::string ext = fs::path(path).extension().string();
+        if (ext == ".html") return "text/html; charset=utf-8";
+        if (ext == ".css") return "text/css; charset=utf-8";
+        if (ext == ".js") return "application/javascript; charset=utf-8";
+        if (ext == ".json") return "application/json";
+        if (ext == ".svg") return "image/svg+xml";
+        if (ext == ".png") return "image/png";
+        if (ext == ".jpg" || ext == ".jpeg") return "image/jpeg";
+        if (ext == ".ico") return "image/x-icon";
+        if (ext == ".txt") return "text/plain; charset=utf-8";
+        return "application/octet-stream";
+    }
+
+    // Уже сжатые форматы повторно не сжимаем
+    bool isCompressible(const std::string& content_type) {
+        return content_type.rfind("text/", 0) == 0 || content_type.rfind("application/javascript", 0) == 0 ||
+               content_type == "application/json" || content_type == "image/svg+xml";
+    }
+
+    bool readWholeFile(const fs::path& path, std::string& out) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.seekg(0, std::ios::end);
+        out.resize((size_t)file.tellg());
+        file.seekg(0, std::ios::beg);
+        file.read(&out[0], out.size());
+        return (bool)file;
+    }
+
+    std::string gzipCompress(const std::string& data) {
+        z_stream stream{};
+        // 15 + 16: окно 32 КБ с заголовком gzip
+        if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return "";
+        }
+        std::string out(deflateBound(&stream, data.size()), '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in = (uInt)data.size();
+        stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+        stream.avail_out = (uInt)out.size();
+        int rc = deflate(&stream, Z_FINISH);
+        out.resize(stream.total_out);
+        deflateEnd(&stream);
+        return rc == Z_STREAM_END ? out : "";
+    }
+
+    std::string brotliCompress(const std::string& data) {
+        size_t size = BrotliEncoderMaxCompressedSize(data.size());
+        if (size == 0) {
+            return "";
+        }
+        std::string out(size, '\0');
+        if (!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                                   data.size(), reinterpret_cast<const uint8_t*>(data.data()),
+                                   &size, reinterpret_cast<uint8_t*>(&out[0]))) {
+            return "";
+        }
+        out.resize(size);
+        return out;
+    }
+
+    // Первые 16 байт SHA-256 содержимого в hex
+    std::string contentHash(const std::string& data) {
+        unsigned char hash[SHA256_DIGEST_LENGTH];
+        SHA256(reinterpret_cast<const unsigned char*>(data.data()), data.size(), hash);
+        static const char hex[] = "0123456789abcdef";
+        std::string out(32, '0');
+        for (size_t i = 0; i < 16; i++) {
+            out[2 * i] = hex[hash[i] >> 4];
+            out[2 * i + 1] = hex[hash[i] & 0xF];
+        }
+        return out;
+    }
+
+    // Совпадает ли If-None-Match с одним из ETag файла
+    bool etagMatches(const std::string& header, const StaticAsset& asset) {
+        if (header == "*") {
+            return true;
+        }
+        std::string base = asset.etag.substr(0, asset.etag.size() - 1);     // Без закрывающей кавычки
+        size_t pos = 0;
+        while ((pos = header.find('"', pos)) != std::string::npos) {
+            size_t end = header.find('"', pos + 1);
+            if (end == std::string::npos) {
+                break;
+            }
+            // Любой вариант (исходный, -gzip, -br) - то же содержимое
+            std::string tag = header.substr(pos, end - pos);
+            if (tag == base || tag == base + "-gzip" || tag == base + "-br") {
+                return true;
+            }
+            pos = end + 1;
+        }
+        return false;
+    }
+
+#ifdef __linux__
+    // inotify не рекурсивен: наблюдение ставится на корень и на каждый подкаталог.
+    // Для уже наблюдаемого каталога inotify_add_watch возвращает тот же дескриптор,
+    // а наблюдение за удаленным снимается само, поэтому обход можно повторять.
+    // false - не удалось наблюдать за корнем
+    bool watchTree(int fd, const std::string& root) {
+        const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MOVED_FROM;
+        if (inotify_add_watch(fd, root.c_str(), mask) < 0) {
+            return false;
+        }
+        std::error_code ec;
+        for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->is_directory(ec) && inotify_add_watch(fd, it->path().c_str(), mask) < 0) {
+                LOG_WARN("Static assets: failed to watch directory", {{"dir", it->path().string()}});
+            }
+        }
+        return true;
+    }
+#endif
+}
+
+StaticAssets::StaticAssets(const std::string& root, long max_age_sec)
+    : root(root), assets(std::make_shared<const AssetMap>()) {
+    cache_control = max_age_sec > 0 ? "public, max-age=" + std::to_string(max_age_sec) : "no-cache";
+}
+
+StaticAssets::~StaticAssets() {
+    stopWatcher();
+}
+
+std::string StaticAssets::resolveRoot(const std::string& configured) {
+    if (!configured.empty()) {
+        return configured;
+    }
+    for (const char* candidate : {"./frontend", "../frontend"}) {
+        std::error_code ec;
+        if (fs::is_directory(candidate, ec)) {
+            return candidate;
+        }
+    }
+    return "./frontend";
+}
+
+bool StaticAssets::load() {
+    std::lock_guard<std::mutex> lock(reload_mutex);
+    std::error_code ec;
+    if (!fs::is_directory(root, ec)) {
+        LOG_ERROR("Static assets: directory not found", {{"dir", root}});
+        return false;
+    }
+
+    auto loaded = std::make_shared<AssetMap>();
+    size_t identity_bytes = 0;
+    size_t compressed_bytes = 0;
+    for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) {
+            continue;
+        }
+        std::string name = fs::relative(it->path(), root, ec).generic_string();
+        StaticAsset asset;
+        if (ec || !readWholeFile(it->path(), asset.identity)) {
+            LOG_WARN("Static assets: failed to read file", {{"path", it->path().string()}});
+            continue;
+        }
+        asset.content_type = contentTypeFor(name);
+        asset.etag = "\"" + contentHash(asset.identity) + "\"";
+        if (isCompressible(asset.content_type)) {
+            asset.gzip = gzipCompress(asset.identity);
+            asset.brotli = brotliCompress(asset.identity);
+            if (asset.gzip.size() >= asset.identity.size()) {
+                asset.gzip.clear();
+            }
+            if (asset.brotli.size() >= asset.identity.size()) {
+                asset.brotli.clear();
+            }
+        }
+        identity_bytes += asset.identity.size();
+        compressed_bytes += asset.brotli.empty() ? asset.identity.size() : asset.brotli.size();
+        (*loaded)[name] = std::move(asset);
+    }
+
+    LOG_INFO("Static assets: files loaded", {{"dir", root}, {"files", loaded->size()},
+                                                {"bytes", identity_bytes}, {"brotli_bytes", compressed_bytes}});
+    std::atomic_store(&assets, std::shared_ptr<const AssetMap>(std::move(loaded)));
+    return true;
+}
+
+size_t StaticAssets::size() const {
+    return std::atomic_load(&assets)->size();
+}
+
+const StaticAsset* StaticAssets::find(const std::shared_ptr<const AssetMap>& snapshot, const std::string& name) const {
+    auto it = snapshot->find(name);
+    return it == snapshot->end() ? nullptr : &it->second;
+}
+
+void StaticAssets::serve(const httplib::Request& req, httplib::Response& res, const std::string& name) const {
+    auto snapshot = std::atomic_load(&assets);
+    const StaticAsset* asset = find(snapshot, name);
+    if (!asset) {
+        res.status = 404;
+        res.set_content("Not Found", "text/plain");
+        return;
+    }
+
+    // Вариант ответа по Accept-Encoding: brotli, затем gzip, затем исходный
+    std::string accept = req.get_header_value("Accept-Encoding");
+    const std::string* body = &asset->identity;
+    const char* encoding = nullptr;
+    std::string etag = asset->etag;
+    if (!asset->brotli.empty() && ResponseCompression::accepts(accept, "br")) {
+        body = &asset->brotli;
+        encoding = "br";
+        etag.insert(etag.size() - 1, "-br");
+    } else if (!asset->gzip.empty() && ResponseCompression::accepts(accept, "gzip")) {
+        body = &asset->gzip;
+        encoding = "gzip";
+        etag.insert(etag.size() - 1, "-gzip");
+    }
+
+    res.set_header("ETag", etag);
+    res.set_header("Cache-Control", cache_control);
+    if (!asset->gzip.empty() || !asset->brotli.empty()) {
+        res.set_header("Vary", "Accept-Encoding");
+    }
+
+    if (req.has_header("If-None-Match") && etagMatches(req.get_header_value("If-None-Match"), *asset)) {
+        res.status = 304;
+        return;
+    }
+
+    if (encoding) {
+        res.set_header("Content-Encoding", encoding);
+    }
+    res.set_content(*body, asset->content_type);
+}
+
+void StaticAssets::startWatcher() {
+#ifdef __linux__
+    if (watching.exchange(true)) {
+        return;
+    }
+    watcher = std::thread(&StaticAssets::watchLoop, this);
+#else
+    LOG_WARN("Static assets: watching for changes is only supported on Linux");
+#endif
+}
+
+void StaticAssets::stopWatcher() {
+    watching = false;
+    if (watcher.joinable()) {
+        watcher.join();
+    }
+}
+
+void StaticAssets::watchLoop() {
+#ifdef __linux__
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("Static assets: inotify unavailable");
+        return;
+    }
+    if (!watchTree(fd, root)) {
+        LOG_ERROR("Static assets: failed to watch directory", {{"dir", root}});
+        close(fd);
+        return;
+    }
+    LOG_INFO("Static assets: watching for changes", {{"dir", root}});
+
+    char buffer[4096];
+    bool dirty = false;
+    while (watching) {
+        // Короткий таймаут - чтобы вовремя заметить остановку и собрать серию событий
+        // (редактор обычно пишет файл в несколько приемов) в одну перезагрузку
+        pollfd pfd{fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, 200);
+        if (ready > 0) {
+            while (read(fd, buffer, sizeof(buffer)) > 0) {
+                dirty = true;
+            }
+            continue;
+        }
+        if (dirty) {
+            dirty = false;
+            // Сначала наблюдение за новыми подкаталогами, потом чтение: файл, появившийся
+            // между ними, вызовет еще одну перезагрузку, а не потеряется
+            watchTree(fd, root);
+            load();
+        }
+    }
+    close(fd);
+#endif
+}
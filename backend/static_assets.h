@@ -0,0 +1,70 @@
+#ifndef STATIC_ASSETS_H
+#define STATIC_ASSETS_H
+
+#include "httplib.h"
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <atomic>
+#include <mutex>
+
+// Файл фронтенда в памяти: исходный вариант и заранее сжатые gzip/brotli
+// (сжатые хранятся, только если они меньше исходного)
+struct StaticAsset {
+    std::string content_type;
+    std::string identity;
+    std::string gzip;
+    std::string brotli;
+    std::string etag;           // Сильный ETag содержимого (у сжатых вариантов - с суффиксом)
+};
+
+// Все файлы каталога frontend/, загруженные в память при старте.
+// Запросы обслуживаются из памяти с ETag/If-None-Match (304) и Cache-Control;
+// вариант ответа выбирается по Accept-Encoding.
+// Набор файлов - неизменяемый снимок, который перезагрузка подменяет атомарно
+// (как снимки DataCache), поэтому чтение идет без блокировок.
+// В режиме разработки поток inotify перезагружает файлы при их изменении (в том числе в подкаталогах).
+class StaticAssets {
+public:
+    using AssetMap = std::unordered_map<std::string, StaticAsset>;
+
+private:
+    std::string root;
+    std::string cache_control;
+    std::shared_ptr<const AssetMap> assets;
+    std::mutex reload_mutex;
+
+    std::thread watcher;
+    std::atomic<bool> watching{false};
+
+    void watchLoop();
+
+public:
+    // max_age_sec = 0: браузер проверяет файл при каждом использовании (no-cache + 304)
+    StaticAssets(const std::string& root, long max_age_sec);
+    ~StaticAssets();
+
+    StaticAssets(const StaticAssets&) = delete;
+    StaticAssets& operator=(const StaticAssets&) = delete;
+
+    // Прочитать и сжать все файлы каталога; false, если каталог не найден
+    bool load();
+
+    // Файл по имени относительно каталога (например "index.html"); nullptr, если его нет
+    const StaticAsset* find(const std::shared_ptr<const AssetMap>& snapshot, const std::string& name) const;
+
+    // Ответить файлом name (404, если его нет)
+    void serve(const httplib::Request& req, httplib::Response& res, const std::string& name) const;
+
+    size_t size() const;
+
+    // Перезагружать файлы при изменениях в каталоге (только Linux)
+    void startWatcher();
+    void stopWatcher();
+
+    // Первый существующий каталог из списка (для запуска из корня проекта или из backend/)
+    static std::string resolveRoot(const std::string& configured);
+};
+
+#endif
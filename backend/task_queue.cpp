@@ -0,0 +1,115 @@
+#include "task_queue.h"
+#include <utility>
+
+namespace {
+    thread_local bool rejecting_thread = false;
+}
+
+BoundedTaskQueue::BoundedTaskQueue(const TaskQueueConfig& config) : config(config) {
+    if (this->config.workers == 0) {
+        this->config.workers = 1;
+    }
+    threads.reserve(this->config.workers + 1);
+    for (size_t i = 0; i < this->config.workers; i++) {
+        threads.emplace_back(&BoundedTaskQueue::workerLoop, this);
+    }
+    threads.emplace_back(&BoundedTaskQueue::rejectLoop, this);
+}
+
+BoundedTaskQueue::~BoundedTaskQueue() {
+    shutdown();
+}
+
+bool BoundedTaskQueue::isRejecting() {
+    return rejecting_thread;
+}
+
+bool BoundedTaskQueue::enqueue(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (shutting_down) {
+            return false;
+        }
+        if (tasks.size() < config.max_queued) {
+            tasks.push_back(std::move(fn));
+            accepted++;
+            tasks_cv.notify_one();
+            return true;
+        }
+        if (rejects.size() < config.max_rejecting) {
+            rejects.push_back(std::move(fn));
+            rejected++;
+            rejects_cv.notify_one();
+            return true;
+        }
+    }
+    // httplib закроет сокет сам
+    dropped++;
+    return false;
+}
+
+void BoundedTaskQueue::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (shutting_down) {
+            return;
+        }
+        shutting_down = true;
+    }
+    tasks_cv.notify_all();
+    rejects_cv.notify_all();
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+TaskQueueStats BoundedTaskQueue::stats() {
+    TaskQueueStats s;
+    s.workers = config.workers;
+    s.busy = busy.load();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        s.queued = tasks.size();
+    }
+    s.accepted = accepted.load();
+    s.rejected = rejected.load();
+    s.dropped = dropped.load();
+    return s;
+}
+
+void BoundedTaskQueue::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            tasks_cv.wait(lock, [this] { return !tasks.empty() || shutting_down; });
+            if (tasks.empty()) {
+                return;     // Остановка, очередь разобрана
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        busy++;
+        task();
+        busy--;
+    }
+}
+
+void BoundedTaskQueue::rejectLoop() {
+    rejecting_thread = true;
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            rejects_cv.wait(lock, [this] { return !rejects.empty() || shutting_down; });
+            if (rejects.empty()) {
+                return;
+            }
+            task = std::move(rejects.front());
+            rejects.pop_front();
+        }
+        task();
+    }
+}
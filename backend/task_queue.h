@@ -0,0 +1,71 @@
+#ifndef TASK_QUEUE_H
+#define TASK_QUEUE_H
+
+#include "httplib.h"
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Настройки обработки соединений
+struct TaskQueueConfig {
+    size_t workers = 8;             // Потоков, обрабатывающих соединения
+    size_t max_queued = 64;         // Соединений, ожидающих свободный поток
+    size_t max_rejecting = 64;      // Соединений сверх очереди, которым отвечаем 503
+};
+
+// Счетчики очереди (снимок на момент вызова)
+struct TaskQueueStats {
+    size_t workers = 0;
+    size_t busy = 0;            // Потоков, занятых соединением
+    size_t queued = 0;          // Соединений в очереди
+    uint64_t accepted = 0;      // Всего соединений, отданных потокам
+    uint64_t rejected = 0;      // Получили 503 из-за переполнения очереди
+    uint64_t dropped = 0;       // Закрыты без ответа (переполнена и очередь отказов)
+};
+
+// Очередь соединений httplib с фиксированным числом потоков и ограниченной длиной.
+// httplib ставит в очередь каждое принятое соединение. Когда очередь заполнена,
+// соединение передается отдельному потоку отказов: он обрабатывает его как обычно,
+// но isRejecting() в нем возвращает true, и обработчик до маршрутизации отвечает
+// 503 с Retry-After, не трогая БД. Если переполнена и очередь отказов, соединение
+// закрывается без ответа.
+class BoundedTaskQueue : public httplib::TaskQueue {
+private:
+    TaskQueueConfig config;
+
+    std::deque<std::function<void()>> tasks;
+    std::deque<std::function<void()>> rejects;
+    std::mutex mutex;
+    std::condition_variable tasks_cv;
+    std::condition_variable rejects_cv;
+    bool shutting_down = false;
+
+    std::vector<std::thread> threads;
+    std::atomic<size_t> busy{0};
+    std::atomic<uint64_t> accepted{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> dropped{0};
+
+    void workerLoop();
+    void rejectLoop();
+
+public:
+    explicit BoundedTaskQueue(const TaskQueueConfig& config);
+    ~BoundedTaskQueue() override;
+
+    bool enqueue(std::function<void()> fn) override;
+    void shutdown() override;
+
+    TaskQueueStats stats();
+
+    // Текущий поток обслуживает соединение, которому нужно ответить 503
+    static bool isRejecting();
+};
+
+#endif
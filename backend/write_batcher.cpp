@@ -0,0 +1,137 @@
+#include "write_batcher.h"
+#include "log.h"
+#include <algorithm>
+#include <utility>
+
+WriteBatcher::WriteBatcher(ConnectionPool& pool, const WriteBatchConfig& config)
+    : pool(pool), config(config) {
+    if (this->config.max_ops == 0) {
+        this->config.max_ops = 1;
+    }
+}
+
+WriteBatcher::~WriteBatcher() {
+    stop();
+}
+
+void WriteBatcher::start() {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    if (running) {
+        return;
+    }
+    running = true;
+    worker = std::thread(&WriteBatcher::run, this);
+}
+
+void WriteBatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        running = false;
+    }
+    queue_cv.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+std::future<bool> WriteBatcher::submit(Operation op) {
+    Pending pending;
+    pending.op = std::move(op);
+    std::future<bool> result = pending.done.get_future();
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (!running) {
+            // Поток остановлен - ждать некому
+            pending.done.set_value(false);
+            return result;
+        }
+        queue.push_back(std::move(pending));
+    }
+    queue_cv.notify_one();
+    return result;
+}
+
+WriteBatchStats WriteBatcher::stats() const {
+    WriteBatchStats s;
+    s.batches = batches.load();
+    s.operations = operations.load();
+    s.failed = failed.load();
+    return s;
+}
+
+void WriteBatcher::run() {
+    std::vector<Pending> batch;
+    batch.reserve(config.max_ops);
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cv.wait(lock, [this] { return !queue.empty() || !running; });
+            if (queue.empty()) {
+                return;     // Остановлены и очередь пуста
+            }
+
+            // Окно отсчитывается от первой операции: попутчики, пришедшие за это время,
+            // коммитятся вместе с ней
+            auto deadline = std::chrono::steady_clock::now() + config.window;
+            queue_cv.wait_until(lock, deadline, [this] {
+                return queue.size() >= config.max_ops || !running;
+            });
+
+            size_t count = std::min(queue.size(), config.max_ops);
+            for (size_t i = 0; i < count; i++) {
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+        }
+
+        execute(batch);
+        batch.clear();
+    }
+}
+
+void WriteBatcher::execute(std::vector<Pending>& batch) {
+    std::vector<bool> ok(batch.size(), false);
+    std::vector<AfterCommit> after(batch.size());
+    bool committed = false;
+
+    try {
+        auto conn = pool.acquire();
+        try {
+            pqxx::work txn(*conn);
+            for (size_t i = 0; i < batch.size(); i++) {
+                try {
+                    pqxx::subtransaction savepoint(txn, "write_op");
+                    after[i] = batch[i].op(savepoint);
+                    savepoint.commit();
+                    ok[i] = true;
+                } catch (const pqxx::broken_connection&) {
+                    throw;
+                } catch (const std::exception& e) {
+                    LOG_ERROR("Database error in write batch operation", {{"error", e.what()}});
+                }
+            }
+            txn.commit();
+            committed = true;
+        } catch (const pqxx::broken_connection&) {
+            conn.markBroken();
+            throw;
+        }
+    } catch (const std::exception& e) {
+        // Коммит не прошел: ни одна операция пакета не сохранена
+        LOG_ERROR("Database error in write batch", {{"ops", batch.size()}, {"error", e.what()}});
+    }
+
+    batches++;
+    operations += batch.size();
+    for (size_t i = 0; i < batch.size(); i++) {
+        bool success = committed && ok[i];
+        if (success && after[i]) {
+            after[i]();
+        }
+        if (!success) {
+            failed++;
+        }
+        batch[i].done.set_value(success);
+    }
+}
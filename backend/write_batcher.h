@@ -0,0 +1,83 @@
+#ifndef WRITE_BATCHER_H
+#define WRITE_BATCHER_H
+
+#include "connection_pool.h"
+#include <pqxx/pqxx>
+#include <vector>
+#include <deque>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// Настройки группового коммита
+struct WriteBatchConfig {
+    std::chrono::microseconds window{2000};     // Сколько ждать попутчиков после первой операции
+    size_t max_ops = 256;                       // Пакет уходит сразу, когда набралось столько операций
+};
+
+// Счетчики группового коммита
+struct WriteBatchStats {
+    uint64_t batches = 0;       // Закоммиченных (или неудачных) транзакций
+    uint64_t operations = 0;    // Всего операций
+    uint64_t failed = 0;        // Операций, завершившихся ошибкой
+};
+
+// Групповой коммит изменений: операции, пришедшие из разных потоков в течение
+// короткого окна, выполняются фоновым потоком в одной транзакции, и вместо
+// одного fsync на запрос получается один на пакет.
+// Каждая операция идет в своей точке сохранения (subtransaction), поэтому ошибка
+// одной откатывает только ее, а остальные операции пакета коммитятся. Каждый
+// вызывающий получает свой результат через future.
+class WriteBatcher {
+public:
+    // Действие после успешного коммита (обновление кэша); может быть пустым
+    using AfterCommit = std::function<void()>;
+    // Операция выполняется внутри общей транзакции и бросает исключение при ошибке
+    using Operation = std::function<AfterCommit(pqxx::transaction_base&)>;
+
+private:
+    struct Pending {
+        Operation op;
+        std::promise<bool> done;
+    };
+
+    ConnectionPool& pool;
+    WriteBatchConfig config;
+
+    std::deque<Pending> queue;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    bool running = false;
+    std::thread worker;
+
+    std::atomic<uint64_t> batches{0};
+    std::atomic<uint64_t> operations{0};
+    std::atomic<uint64_t> failed{0};
+
+    void run();
+    void execute(std::vector<Pending>& batch);
+
+public:
+    WriteBatcher(ConnectionPool& pool, const WriteBatchConfig& config = WriteBatchConfig());
+    ~WriteBatcher();
+
+    WriteBatcher(const WriteBatcher&) = delete;
+    WriteBatcher& operator=(const WriteBatcher&) = delete;
+
+    void start();
+    // Выполнить уже поставленные операции и остановить поток
+    void stop();
+
+    // Поставить операцию в очередь; future получит true, если она закоммичена
+    std::future<bool> submit(Operation op);
+
+    WriteBatchStats stats() const;
+};
+
+#endif
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+# Сравнение двух результатов micro_bench (JSON Google Benchmark): базового и нового.
+# Для каждого бенчмарка - время до и после и изменение в процентах; код выхода 1,
+# если хоть один бенчмарк замедлился больше порога.
+# Запуск: python3 bench/compare.py base.json new.json [--threshold 10] [--metric real_time]
+import argparse
+import json
+import sys
+
+UNIT_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path, metric):
+    """Имя бенчмарка -> время одной итерации, нс.
+
+    При --benchmark_repetitions берется медиана, иначе среднее по запускам с тем же именем.
+    """
+    with open(path, encoding="utf-8") as f:
+        data = json.load(f)
+    medians = {}
+    runs = {}
+    for b in data.get("benchmarks", []):
+        if b.get("error_occurred"):
+            continue
+        name = b.get("run_name", b["name"])
+        value = b[metric] * UNIT_NS[b.get("time_unit", "ns")]
+        if b.get("run_type") == "aggregate":
+            if b.get("aggregate_name") == "median":
+                medians[name] = value
+        else:
+            runs.setdefault(name, []).append(value)
+    result = {name: sum(values) / len(values) for name, values in runs.items()}
+    result.update(medians)
+    return result
+
+
+def format_ns(value):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if value >= scale:
+            return "%.3g %s" % (value / scale, unit)
+    return "%.3g ns" % value
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Поиск регрессий между двумя прогонами micro_bench")
+    parser.add_argument("baseline", help="JSON базового прогона")
+    parser.add_argument("current", help="JSON нового прогона")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="допустимое замедление, %% (по умолчанию 10)")
+    parser.add_argument("--metric", choices=("cpu_time", "real_time"), default="cpu_time")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline, args.metric)
+    current = load(args.current, args.metric)
+
+    regressions = 0
+    width = max([len(name) for name in current] + [len("Бенчмарк")])
+    print("%-*s %12s %12s %9s" % (width, "Бенчмарк", "было", "стало", "изм."))
+    for name, value in current.items():
+        if name not in baseline:
+            print("%-*s %12s %12s %9s" % (width, name, "-", format_ns(value), "новый"))
+            continue
+        before = baseline[name]
+        change = (value - before) / before * 100.0 if before > 0 else 0.0
+        mark = ""
+        if change > args.threshold:
+            mark = "  РЕГРЕССИЯ"
+            regressions += 1
+        print("%-*s %12s %12s %+8.1f%%%s" % (width, name, format_ns(before), format_ns(value), change, mark))
+    for name in baseline:
+        if name not in current:
+            print("%-*s %12s %12s %9s" % (width, name, format_ns(baseline[name]), "-", "удален"))
+
+    if regressions:
+        print("\nЗамедлилось больше чем на %g%%: %d" % (args.threshold, regressions))
+        return 1
+    print("\nРегрессий нет (порог %g%%)" % args.threshold)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,67 @@
+// Пропускная способность хеширования паролей (scrypt) через HashingPool
+// в зависимости от числа потоков пула при фиксированном числе параллельных клиентов.
+// Сборка и запуск: make bench-hash
+#include "password_hash.h"
+#include "hashing_pool.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    const size_t CLIENTS = 16;              // Параллельных запросов входа
+    const size_t HASHES_PER_CLIENT = 8;
+
+    void run(size_t workers, size_t max_queued) {
+        HashingPoolConfig config;
+        config.workers = workers;
+        config.max_queued = max_queued;
+        HashingPool pool(config);
+
+        std::atomic<uint64_t> done{0};
+        std::atomic<uint64_t> rejected{0};
+        std::atomic<uint64_t> latency_us{0};
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> clients;
+        for (size_t c = 0; c < CLIENTS; c++) {
+            clients.emplace_back([&] {
+                for (size_t i = 0; i < HASHES_PER_CLIENT; i++) {
+                    auto begin = std::chrono::steady_clock::now();
+                    bool accepted = pool.run([] { PasswordHash::hashPassword("benchmark-password"); });
+                    if (!accepted) {
+                        rejected++;
+                        continue;
+                    }
+                    latency_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - begin).count();
+                    done++;
+                }
+            });
+        }
+        for (auto& client : clients) {
+            client.join();
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "workers " << workers << ", queue " << max_queued << ": "
+                  << done / seconds << " хешей/с, средняя задержка "
+                  << (done ? latency_us / done / 1000.0 : 0.0) << " мс, отклонено "
+                  << rejected << " из " << CLIENTS * HASHES_PER_CLIENT << std::endl;
+    }
+}
+
+int main() {
+    PasswordHash::Params params = PasswordHash::getParams();
+    std::cout << "scrypt n=" << params.n << " r=" << params.r << " p=" << params.p
+              << ", клиентов: " << CLIENTS << ", ядер: " << std::thread::hardware_concurrency() << std::endl;
+    for (size_t workers : {1, 2, 4, 8}) {
+        // Очередь без ограничения: сколько хешей в секунду дает пул такого размера
+        run(workers, CLIENTS);
+        // Очередь по умолчанию (workers * 2): лишние запросы отклоняются сразу
+        run(workers, workers * 2);
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Сравнение сериализации /api/grades: старая склейка строк против JsonWriter.
+// Сборка и запуск: make bench-json
+#include "api_json.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    const size_t ROWS = 100000;
+    const int RUNS = 20;
+
+    std::vector<Grade> makeGrades() {
+        const char* subjects[] = {"Математика", "Программирование", "Базы данных", "Физика"};
+        std::vector<Grade> grades;
+        grades.reserve(ROWS);
+        for (size_t i = 0; i < ROWS; i++) {
+            Grade g;
+            g.id = (int)i + 1;
+            g.student_id = (int)(i / 8) + 1;
+            g.subject = subjects[i % 4];
+            g.grade = (int)(i % 5) + 1;
+            g.semester = (int)(i % 8) + 1;
+            g.attendance_percent = 50.0 + (double)(i % 5000) / 100.0;
+            g.assignment_completion = 40.0 + (double)(i % 6000) / 100.0;
+            g.exam_result = (int)(i % 4) + 2;
+            grades.push_back(g);
+        }
+        return grades;
+    }
+
+    // Реализация обработчика /api/grades до перехода на JsonWriter
+    std::string concatenation(const std::vector<Grade>& grades) {
+        std::string json = "[";
+        for (size_t i = 0; i < grades.size(); i++) {
+            json += "{";
+            json += "\"id\": " + std::to_string(grades[i].id) + ",";
+            json += "\"student_id\": " + std::to_string(grades[i].student_id) + ",";
+            json += "\"subject\": \"" + grades[i].subject + "\",";
+            json += "\"grade\": " + std::to_string(grades[i].grade) + ",";
+            json += "\"semester\": " + std::to_string(grades[i].semester) + ",";
+            json += "\"attendance_percent\": " + std::to_string(grades[i].attendance_percent) + ",";
+            json += "\"assignment_completion\": " + std::to_string(grades[i].assignment_completion) + ",";
+            json += "\"exam_result\": " + std::to_string(grades[i].exam_result);
+            json += "}";
+            if (i < grades.size() - 1) json += ",";
+        }
+        json += "]";
+        return json;
+    }
+
+    std::string writer(const std::vector<Grade>& grades) {
+        JsonWriter json(64 + grades.size() * 192);
+        ApiJson::writeArray(json, grades);
+        return json.take();
+    }
+
+    template<typename F>
+    void run(const char* name, F serialize, const std::vector<Grade>& grades) {
+        size_t bytes = 0;
+        double best = 1e18;
+        for (int r = 0; r < RUNS; r++) {
+            auto start = std::chrono::steady_clock::now();
+            std::string out = serialize(grades);
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            bytes = out.size();
+            if (elapsed < best) {
+                best = elapsed;
+            }
+        }
+        std::cout << name << ": " << best << " мс (лучший из " << RUNS << "), "
+                  << bytes << " байт, " << (bytes / 1048576.0) / (best / 1000.0) << " МБ/с" << std::endl;
+    }
+}
+
+int main() {
+    std::vector<Grade> grades = makeGrades();
+    std::cout << "Сериализация " << ROWS << " оценок" << std::endl;
+    run("concatenation", concatenation, grades);
+    run("JsonWriter   ", writer, grades);
+    return 0;
+}
@@ -0,0 +1,91 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+// Гистограмма задержек в духе HdrHistogram: значения до 128 хранятся точно, дальше
+// каждый интервал [2^k, 2^(k+1)) делится на 64 равные корзины - относительная
+// погрешность перцентилей не больше 1/64 (~1.6%) во всем диапазоне uint64_t.
+// Запись - несколько сдвигов и одно сложение; у каждого потока своя гистограмма,
+// в конце они складываются через merge
+class LatencyHistogram {
+private:
+    static constexpr int SUB_BITS = 6;                      // 64 корзины на степень двойки
+    static constexpr uint64_t SUB_COUNT = 1ull << SUB_BITS;
+    static constexpr uint64_t EXACT = SUB_COUNT * 2;        // Значения меньше - без округления
+    static constexpr size_t BUCKETS = EXACT + (64 - SUB_BITS - 1) * SUB_COUNT;
+
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+    uint64_t max_value = 0;
+    uint64_t min_value = UINT64_MAX;
+    long double sum = 0;
+
+    static size_t index(uint64_t value) {
+        if (value < EXACT) {
+            return (size_t)value;
+        }
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - SUB_BITS;                         // value >> shift в [64, 128)
+        uint64_t sub = value >> shift;
+        return (size_t)(EXACT + (uint64_t)(shift - 1) * SUB_COUNT + (sub - SUB_COUNT));
+    }
+
+    // Наибольшее значение, попадающее в корзину i
+    static uint64_t highest(size_t i) {
+        if (i < EXACT) {
+            return i;
+        }
+        uint64_t shift = (i - EXACT) / SUB_COUNT + 1;
+        uint64_t sub = (i - EXACT) % SUB_COUNT + SUB_COUNT;
+        return ((sub + 1) << shift) - 1;
+    }
+
+public:
+    LatencyHistogram() : counts(BUCKETS, 0) {}
+
+    void record(uint64_t value) {
+        counts[index(value)]++;
+        total++;
+        sum += value;
+        max_value = std::max(max_value, value);
+        min_value = std::min(min_value, value);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BUCKETS; i++) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        sum += other.sum;
+        max_value = std::max(max_value, other.max_value);
+        min_value = std::min(min_value, other.min_value);
+    }
+
+    // Значение, не меньше которого p процентов записей (p в [0, 100])
+    uint64_t percentile(double p) const {
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t target = (uint64_t)(p / 100.0 * (double)total + 0.5);
+        target = std::max<uint64_t>(1, std::min(target, total));
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < BUCKETS; i++) {
+            cumulative += counts[i];
+            if (cumulative >= target) {
+                return std::min(highest(i), max_value);
+            }
+        }
+        return max_value;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t max() const { return max_value; }
+    uint64_t min() const { return total ? min_value : 0; }
+    double mean() const { return total ? (double)(sum / total) : 0.0; }
+};
+
+#endif
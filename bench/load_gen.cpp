@@ -0,0 +1,354 @@
+// Нагрузочный тест HTTP API: вход, затем смесь запросов /api/students, /api/grades,
+// /api/predict и добавления оценок (админ) с заданной частотой или с заданным числом
+// одновременных запросов. Задержки - перцентили по гистограмме LatencyHistogram.
+//
+// Режим --rate (открытая модель): запрос i должен уйти в момент start + i / rate,
+// задержка считается от этого момента, а не от фактической отправки. Если сервер
+// тормозит и все соединения заняты, ожидание отправки входит в задержку - иначе
+// медленные ответы скрыли бы очередь перед ними (coordinated omission).
+// Режим --concurrency (закрытая модель): каждое соединение шлет следующий запрос
+// сразу после ответа; задержка - чистое время ответа.
+//
+// Данные: make bench-seed ARGS="--students 1000 --grades 20 --reset 1" (id студентов 1..N).
+// Сборка и запуск: make bench-load ARGS="--rate 500 --duration 30"
+#include "httplib.h"
+#include "latency_histogram.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    enum Endpoint {
+        STUDENTS,
+        GRADES,
+        PREDICT,
+        WRITE,
+        ENDPOINT_COUNT
+    };
+    const char* const ENDPOINT_NAMES[] = {"students", "grades", "predict", "write"};
+    const char* const SUBJECTS[] = {"Математика", "Программирование", "Базы данных", "Физика"};
+
+    struct Options {
+        std::string host = "127.0.0.1";
+        int port = 8080;
+        std::string user = "admin";
+        std::string password = "admin";
+        double rate = 0;                    // Запросов в секунду (0 - режим concurrency)
+        size_t connections = 32;            // Соединений (потоков) в обоих режимах
+        double duration_sec = 30;
+        double warmup_sec = 5;              // Первые секунды не входят в результат
+        unsigned weights[ENDPOINT_COUNT] = {40, 30, 25, 5};
+        int students = 1000;                // id студентов для запросов: 1..students
+        int limit = 100;                    // Размер страницы списков (0 - весь список)
+        bool compressed = false;            // Accept-Encoding: zstd, gzip (тело не распаковывается)
+    };
+
+    // --name=value или --name value
+    std::string setting(int argc, char* argv[], const std::string& name, const std::string& defaultValue) {
+        std::string flag = "--" + name;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == flag && i + 1 < argc) {
+                return argv[i + 1];
+            }
+            if (arg.rfind(flag + "=", 0) == 0) {
+                return arg.substr(flag.size() + 1);
+            }
+        }
+        return defaultValue;
+    }
+
+    // "students=40,grades=30,predict=25,write=5"; не указанные в строке получают 0
+    bool parseMix(const std::string& text, unsigned weights[ENDPOINT_COUNT]) {
+        unsigned parsed[ENDPOINT_COUNT] = {};
+        std::stringstream ss(text);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            size_t eq = item.find('=');
+            if (eq == std::string::npos) {
+                return false;
+            }
+            std::string name = item.substr(0, eq);
+            int e = 0;
+            while (e < ENDPOINT_COUNT && name != ENDPOINT_NAMES[e]) {
+                e++;
+            }
+            if (e == ENDPOINT_COUNT) {
+                return false;
+            }
+            parsed[e] = (unsigned)std::stoul(item.substr(eq + 1));
+        }
+        unsigned total = 0;
+        for (int e = 0; e < ENDPOINT_COUNT; e++) {
+            weights[e] = parsed[e];
+            total += parsed[e];
+        }
+        return total > 0;
+    }
+
+    // Значение строкового поля name из ответа JsonWriter (без пробелов между токенами)
+    std::string jsonString(const std::string& body, const std::string& name) {
+        std::string key = "\"" + name + "\":\"";
+        size_t pos = body.find(key);
+        if (pos == std::string::npos) {
+            return "";
+        }
+        pos += key.size();
+        size_t end = body.find('"', pos);
+        return end == std::string::npos ? "" : body.substr(pos, end - pos);
+    }
+
+    struct WorkerResult {
+        LatencyHistogram latency[ENDPOINT_COUNT];
+        uint64_t status[ENDPOINT_COUNT][6] = {};    // По первой цифре кода ответа
+        uint64_t failed[ENDPOINT_COUNT] = {};       // Ответа нет: соединение, таймаут
+        uint64_t bytes = 0;
+        uint64_t late = 0;                          // Запросов, ушедших позже назначенного (режим rate)
+    };
+
+    class Worker {
+    private:
+        const Options& options;
+        const std::string& session_id;
+        httplib::Client client;
+        httplib::Headers headers;
+        std::mt19937_64 rng;
+        unsigned total_weight = 0;
+
+    public:
+        WorkerResult result;
+
+        Worker(const Options& options, const std::string& session_id, size_t id)
+            : options(options), session_id(session_id), client(options.host, options.port), rng(id * 7919 + 1) {
+            client.set_keep_alive(true);
+            client.set_connection_timeout(5);
+            client.set_read_timeout(30);
+            if (options.compressed) {
+                headers.emplace("Accept-Encoding", "zstd, gzip");
+            }
+            for (unsigned w : options.weights) {
+                total_weight += w;
+            }
+        }
+
+        Endpoint pick() {
+            unsigned r = (unsigned)(rng() % total_weight);
+            int e = 0;
+            while (r >= options.weights[e]) {
+                r -= options.weights[e];
+                e++;
+            }
+            return (Endpoint)e;
+        }
+
+        int randomStudent() {
+            return (int)(rng() % (uint64_t)options.students) + 1;
+        }
+
+        httplib::Result send(Endpoint endpoint) {
+            std::string session = "session_id=" + session_id;
+            std::string page = options.limit > 0 ? "&limit=" + std::to_string(options.limit) : "";
+            switch (endpoint) {
+                case STUDENTS: {
+                    std::string after = options.limit > 0 ? "&after_id=" + std::to_string(randomStudent() - 1) : "";
+                    return client.Get("/api/students?" + session + page + after, headers);
+                }
+                case GRADES: {
+                    std::string student = options.limit > 0 ? "&student_id=" + std::to_string(randomStudent()) : "";
+                    return client.Get("/api/grades?" + session + page + student, headers);
+                }
+                case PREDICT:
+                    return client.Get("/api/predict?" + session + "&student_id=" + std::to_string(randomStudent()), headers);
+                default: {
+                    int grade = (int)(rng() % 4) + 2;
+                    httplib::Params params{
+                        {"session_id", session_id},
+                        {"student_id", std::to_string(randomStudent())},
+                        {"subject", SUBJECTS[rng() % 4]},
+                        {"grade", std::to_string(grade)},
+                        {"semester", std::to_string(rng() % 8 + 1)},
+                        {"attendance", std::to_string(50 + rng() % 51)},
+                        {"assignment", std::to_string(40 + rng() % 61)},
+                        {"exam_result", std::to_string(grade)}};
+                    return client.Post("/api/admin/grades/add", headers, params);
+                }
+            }
+        }
+
+        // Выполнить запрос; задержка считается от intended (в режиме rate - назначенное время)
+        void request(Clock::time_point intended, bool measured) {
+            Endpoint endpoint = pick();
+            httplib::Result res = send(endpoint);
+            auto done = Clock::now();
+            if (!measured) {
+                return;
+            }
+            if (!res) {
+                result.failed[endpoint]++;
+                return;
+            }
+            result.status[endpoint][std::min(res->status / 100, 5)]++;
+            result.bytes += res->body.size();
+            result.latency[endpoint].record(
+                (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(done - intended).count());
+        }
+    };
+
+    std::string login(const Options& options) {
+        httplib::Client client(options.host, options.port);
+        httplib::Result res = client.Post("/api/login", httplib::Params{
+            {"username", options.user}, {"password", options.password}});
+        if (!res) {
+            std::cerr << "Сервер " << options.host << ":" << options.port << " недоступен" << std::endl;
+            return "";
+        }
+        std::string session_id = jsonString(res->body, "session_id");
+        if (session_id.empty()) {
+            std::cerr << "Вход не выполнен (" << res->status << "): " << res->body << std::endl;
+        } else if (options.weights[WRITE] > 0 && jsonString(res->body, "role") != "admin") {
+            std::cerr << "Пользователь " << options.user << " не админ: запросы write получат 403" << std::endl;
+        }
+        return session_id;
+    }
+
+    void printRow(const char* name, const LatencyHistogram& h, const uint64_t status[6], uint64_t failed,
+                  double seconds) {
+        auto ms = [](uint64_t ns) { return (double)ns / 1e6; };
+        std::printf("%-9s %9llu %9.1f %7llu %7llu %7llu %7llu %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+                    name, (unsigned long long)h.count(), h.count() / seconds,
+                    (unsigned long long)status[2], (unsigned long long)status[4], (unsigned long long)status[5],
+                    (unsigned long long)failed, h.mean() / 1e6,
+                    ms(h.percentile(50)), ms(h.percentile(90)), ms(h.percentile(99)), ms(h.percentile(99.9)),
+                    ms(h.max()));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    options.host = setting(argc, argv, "host", options.host);
+    options.port = std::stoi(setting(argc, argv, "port", std::to_string(options.port)));
+    options.user = setting(argc, argv, "user", options.user);
+    options.password = setting(argc, argv, "password", options.password);
+    options.rate = std::stod(setting(argc, argv, "rate", "0"));
+    options.connections = std::stoul(setting(argc, argv, "concurrency",
+                                             setting(argc, argv, "connections", std::to_string(options.connections))));
+    options.duration_sec = std::stod(setting(argc, argv, "duration", "30"));
+    options.warmup_sec = std::stod(setting(argc, argv, "warmup", "5"));
+    options.students = std::stoi(setting(argc, argv, "students", std::to_string(options.students)));
+    options.limit = std::stoi(setting(argc, argv, "limit", std::to_string(options.limit)));
+    options.compressed = setting(argc, argv, "compressed", "0") != "0";
+    std::string mix = setting(argc, argv, "mix", "students=40,grades=30,predict=25,write=5");
+    if (!parseMix(mix, options.weights) || options.connections == 0 || options.students <= 0 ||
+        options.duration_sec <= options.warmup_sec) {
+        std::cerr << "Использование: load_gen [--host 127.0.0.1] [--port 8080] [--user admin] [--password admin]\n"
+                  << "  [--rate N | --concurrency N] [--connections N] [--duration 30] [--warmup 5]\n"
+                  << "  [--mix students=40,grades=30,predict=25,write=5] [--students 1000] [--limit 100]\n"
+                  << "  [--compressed 1]" << std::endl;
+        return 1;
+    }
+
+    std::string session_id = login(options);
+    if (session_id.empty()) {
+        return 1;
+    }
+
+    bool open_model = options.rate > 0;
+    std::cout << (open_model ? "Режим rate: " + std::to_string((long)options.rate) + " запросов/с, "
+                             : std::string("Режим concurrency: "))
+              << options.connections << " соединений, " << options.duration_sec << " с (прогрев "
+              << options.warmup_sec << " с), смесь " << mix << std::endl;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (size_t i = 0; i < options.connections; i++) {
+        workers.push_back(std::make_unique<Worker>(options, session_id, i));
+    }
+
+    auto start = Clock::now() + std::chrono::milliseconds(100);
+    auto measure_from = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.warmup_sec));
+    auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration_sec));
+    std::chrono::nanoseconds interval(open_model ? (long long)(1e9 / options.rate) : 0);
+    std::atomic<uint64_t> next{0};
+
+    std::vector<std::thread> threads;
+    for (auto& worker : workers) {
+        Worker* w = worker.get();
+        threads.emplace_back([&, w] {
+            std::this_thread::sleep_until(start);
+            while (true) {
+                Clock::time_point intended;
+                if (open_model) {
+                    // Общее расписание: запрос i назначен на start + i * interval
+                    intended = start + interval * next.fetch_add(1);
+                    if (intended >= end) {
+                        break;
+                    }
+                    if (intended > Clock::now()) {
+                        std::this_thread::sleep_until(intended);
+                    } else if (Clock::now() - intended > std::chrono::milliseconds(1)) {
+                        w->result.late++;
+                    }
+                } else {
+                    intended = Clock::now();
+                    if (intended >= end) {
+                        break;
+                    }
+                }
+                w->request(intended, intended >= measure_from);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    // Фактическое время измерения: в режиме rate отстающий сервер отвечает и после end
+    double seconds = std::chrono::duration<double>(Clock::now() - measure_from).count();
+
+    WorkerResult total;
+    for (auto& worker : workers) {
+        for (int e = 0; e < ENDPOINT_COUNT; e++) {
+            total.latency[e].merge(worker->result.latency[e]);
+            for (int s = 0; s < 6; s++) {
+                total.status[e][s] += worker->result.status[e][s];
+            }
+            total.failed[e] += worker->result.failed[e];
+        }
+        total.bytes += worker->result.bytes;
+        total.late += worker->result.late;
+    }
+
+    std::printf("\n%-9s %9s %9s %7s %7s %7s %7s %9s %9s %9s %9s %9s %9s\n", "endpoint", "requests", "req/s",
+                "2xx", "4xx", "5xx", "failed", "mean,ms", "p50,ms", "p90,ms", "p99,ms", "p99.9,ms", "max,ms");
+    LatencyHistogram all;
+    uint64_t all_status[6] = {};
+    uint64_t all_failed = 0;
+    for (int e = 0; e < ENDPOINT_COUNT; e++) {
+        if (options.weights[e] == 0) {
+            continue;
+        }
+        printRow(ENDPOINT_NAMES[e], total.latency[e], total.status[e], total.failed[e], seconds);
+        all.merge(total.latency[e]);
+        for (int s = 0; s < 6; s++) {
+            all_status[s] += total.status[e][s];
+        }
+        all_failed += total.failed[e];
+    }
+    printRow("all", all, all_status, all_failed, seconds);
+    std::printf("\nПринято %.1f МБ", (double)total.bytes / (1024 * 1024));
+    if (open_model) {
+        // Много опоздавших - соединений не хватает на заданную частоту (или сервер не успевает)
+        std::printf(", запросов ушло позже назначенного: %llu", (unsigned long long)total.late);
+    }
+    std::printf("\n");
+    return 0;
+}
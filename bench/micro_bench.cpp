@@ -0,0 +1,228 @@
+// Микробенчмарки CPU-затратных частей сервера по отдельности (Google Benchmark):
+// хеширование паролей, прогноз по оценкам в памяти, JSON ответа /api/grades,
+// отдача файлов фронтенда из памяти. Без БД и без HTTP.
+// Сборка и запуск: make bench (результат в JSON - build/bench.json),
+// сравнение с сохраненным результатом: make bench-compare BASELINE=...
+#include "password_hash.h"
+#include "prediction.h"
+#include "api_json.h"
+#include "json_writer.h"
+#include "static_assets.h"
+#include "log.h"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    const char* const SUBJECTS[] = {"Математика", "Программирование", "Базы данных", "Физика"};
+
+    std::vector<Grade> makeGrades(size_t rows, size_t per_student) {
+        std::mt19937 rng(42);
+        std::vector<Grade> grades;
+        grades.reserve(rows);
+        for (size_t i = 0; i < rows; i++) {
+            Grade g;
+            g.id = (int)i + 1;
+            g.student_id = (int)(i / per_student) + 1;
+            g.subject = SUBJECTS[i % 4];
+            g.grade = (int)(rng() % 4) + 2;
+            g.semester = (int)(i % 8) + 1;
+            g.attendance_percent = 40.0 + (double)(rng() % 6000) / 100.0;
+            g.assignment_completion = 40.0 + (double)(rng() % 6000) / 100.0;
+            g.exam_result = (int)(rng() % 4) + 2;
+            grades.push_back(g);
+        }
+        return grades;
+    }
+
+    // Параметры scrypt на время бенчмарка (глобальные для PasswordHash)
+    class ScopedScryptN {
+    private:
+        PasswordHash::Params saved;
+
+    public:
+        explicit ScopedScryptN(uint64_t n) : saved(PasswordHash::getParams()) {
+            PasswordHash::Params params = saved;
+            params.n = n;
+            PasswordHash::setParams(params);
+        }
+        ~ScopedScryptN() { PasswordHash::setParams(saved); }
+    };
+}
+
+// --- PasswordHash ---
+
+static void BM_ToHex(benchmark::State& state) {
+    std::vector<unsigned char> data((size_t)state.range(0));
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = (unsigned char)(i * 37);
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PasswordHash::toHex(data.data(), data.size()));
+    }
+    state.SetBytesProcessed((int64_t)state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ToHex)->Arg(16)->Arg(32)->Arg(1024);
+
+// Аргумент - параметр стоимости scrypt n (16384 - значение по умолчанию)
+static void BM_HashPassword(benchmark::State& state) {
+    ScopedScryptN params((uint64_t)state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PasswordHash::hashPassword("benchmark-password"));
+    }
+}
+BENCHMARK(BM_HashPassword)->Arg(1024)->Arg(16384)->Unit(benchmark::kMillisecond);
+
+static void BM_VerifyPassword(benchmark::State& state) {
+    ScopedScryptN params((uint64_t)state.range(0));
+    std::string hash = PasswordHash::hashPassword("benchmark-password");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PasswordHash::verifyPassword("benchmark-password", hash));
+    }
+}
+BENCHMARK(BM_VerifyPassword)->Arg(1024)->Arg(16384)->Unit(benchmark::kMillisecond);
+
+// Хеш в старом формате или с другими параметрами - проверяется на каждом входе
+static void BM_NeedsRehash(benchmark::State& state) {
+    std::string hash = PasswordHash::hashPassword("benchmark-password");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(PasswordHash::needsRehash(hash));
+    }
+}
+BENCHMARK(BM_NeedsRehash);
+
+// --- Прогноз ---
+
+// Путь predictExamSuccess без кэша: Predictor::predictStudent и текст прогноза.
+// Аргумент - число оценок у студента
+static void BM_PredictStudent(benchmark::State& state) {
+    std::vector<Grade> grades = makeGrades((size_t)state.range(0), (size_t)state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Predictor::describe(Predictor::predictStudent(1, grades)));
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PredictStudent)->Arg(8)->Arg(64)->Arg(1024);
+
+// Путь с кэшем: суммы уже посчитаны, остается формула и текст
+static void BM_PredictFromSums(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Predictor::describe(Predictor::fromSums(1, 32.0, 620.0, 655.0, 8)));
+    }
+}
+BENCHMARK(BM_PredictFromSums);
+
+// predictAll: прогноз всех студентов за один проход по столбцам (по 8 оценок на студента)
+static void BM_PredictAll(benchmark::State& state, Predictor::Kernel kernel) {
+    if (kernel == Predictor::Kernel::Avx2 && !Predictor::avx2Supported()) {
+        state.SkipWithError("AVX2 не поддерживается");
+        return;
+    }
+    GradeColumns columns;
+    std::vector<Grade> grades = makeGrades((size_t)state.range(0), 8);
+    columns.reserve(grades.size());
+    for (const auto& g : grades) {
+        columns.push(g);
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Predictor::predictAll(columns, kernel));
+    }
+    state.SetItemsProcessed((int64_t)state.iterations() * state.range(0));
+}
+BENCHMARK_CAPTURE(BM_PredictAll, scalar, Predictor::Kernel::Scalar)->Arg(1 << 12)->Arg(1 << 18);
+BENCHMARK_CAPTURE(BM_PredictAll, avx2, Predictor::Kernel::Avx2)->Arg(1 << 12)->Arg(1 << 18);
+
+// --- JSON ответа /api/grades ---
+
+// Страница: {"items": [...], "next_after_id": ...}, как sendPage в server.cpp
+static void BM_GradesPageJson(benchmark::State& state) {
+    std::vector<Grade> page = makeGrades((size_t)state.range(0), 8);
+    size_t bytes = 0;
+    for (auto _ : state) {
+        JsonWriter json(64 + page.size() * 160);
+        json.beginObject().key("items");
+        ApiJson::writeArray(json, page);
+        json.key("next_after_id").value(page.back().id);
+        json.endObject();
+        bytes = json.size();
+        benchmark::DoNotOptimize(json.take());
+    }
+    state.SetBytesProcessed((int64_t)(state.iterations() * bytes));
+    state.SetItemsProcessed((int64_t)state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GradesPageJson)->Arg(100)->Arg(1000);
+
+// Весь список: запись частями по 64 КБ, как streamJsonArray в server.cpp
+static void BM_GradesStreamJson(benchmark::State& state) {
+    const size_t chunk_bytes = 64 * 1024;
+    std::vector<Grade> grades = makeGrades((size_t)state.range(0), 8);
+    size_t bytes = 0;
+    for (auto _ : state) {
+        JsonWriter json(chunk_bytes + 4096);
+        bytes = 0;
+        json.beginArray();
+        for (const auto& g : grades) {
+            ApiJson::write(json, g);
+            if (json.size() >= chunk_bytes) {
+                bytes += json.size();
+                benchmark::DoNotOptimize(json.str().data());
+                json.clear();
+            }
+        }
+        json.endArray();
+        bytes += json.size();
+        benchmark::DoNotOptimize(json.str().data());
+    }
+    state.SetBytesProcessed((int64_t)(state.iterations() * bytes));
+    state.SetItemsProcessed((int64_t)state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GradesStreamJson)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// --- Файлы фронтенда (бывший readFile: теперь файлы читаются один раз в StaticAssets) ---
+
+// Загрузка каталога frontend/: чтение, gzip, brotli, ETag (при старте и перезагрузке)
+static void BM_StaticAssetsLoad(benchmark::State& state) {
+    std::string root = StaticAssets::resolveRoot("");
+    for (auto _ : state) {
+        StaticAssets assets(root, 0);
+        if (!assets.load()) {
+            state.SkipWithError("Каталог frontend не найден");
+            return;
+        }
+    }
+}
+BENCHMARK(BM_StaticAssetsLoad)->Unit(benchmark::kMillisecond);
+
+// Ответ на запрос файла: аргумент 0 - полный ответ (brotli), 1 - 304 по If-None-Match
+static void BM_StaticAssetsServe(benchmark::State& state) {
+    StaticAssets assets(StaticAssets::resolveRoot(""), 0);
+    if (!assets.load()) {
+        state.SkipWithError("Каталог frontend не найден");
+        return;
+    }
+    httplib::Request req;
+    req.headers.emplace("Accept-Encoding", "gzip, deflate, br");
+    if (state.range(0) == 1) {
+        httplib::Response first;
+        assets.serve(req, first, "app.js");
+        req.headers.emplace("If-None-Match", first.get_header_value("ETag"));
+    }
+    for (auto _ : state) {
+        httplib::Response res;
+        assets.serve(req, res, "app.js");
+        benchmark::DoNotOptimize(res.body.data());
+    }
+}
+BENCHMARK(BM_StaticAssetsServe)->Arg(0)->Arg(1);
+
+int main(int argc, char** argv) {
+    // Записи журнала при загрузке файлов не должны попадать в вывод и в замеры
+    Log::setLevel(Log::Level::Error);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
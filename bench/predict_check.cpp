@@ -0,0 +1,97 @@
+// Проверка predictAll: ядра Scalar и AVX2 на одних и тех же случайных столбцах должны
+// давать побитово одинаковый результат (см. prediction.h). Код выхода 1 при расхождении.
+// Сборка и запуск: make bench-predict
+#include "prediction.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+    const int SEEDS = 20;
+    const size_t SEGMENT_COUNTS[] = {0, 1, 2, 3, 4, 5, 7, 8, 9, 100, 1001, 50000};
+
+    // Блоки строк случайной длины (1..64, иногда длинные); значения - как в БД
+    // (оценки целые, проценты с двумя знаками) и произвольные, чтобы проверить округление
+    GradeColumns makeColumns(size_t segments, std::mt19937_64& rng) {
+        std::uniform_int_distribution<int> length(1, 64);
+        std::uniform_int_distribution<int> grade(1, 5);
+        std::uniform_int_distribution<int> percent(0, 10000);
+        std::uniform_real_distribution<double> any(0.0, 100.0);
+
+        GradeColumns columns;
+        int student_id = 0;
+        for (size_t s = 0; s < segments; s++) {
+            student_id += 1 + (int)(rng() % 3);
+            int rows = rng() % 50 == 0 ? 500 + (int)(rng() % 500) : length(rng);
+            bool exact = rng() % 2 == 0;
+            for (int i = 0; i < rows; i++) {
+                Grade g;
+                g.id = 0;
+                g.student_id = student_id;
+                g.grade = grade(rng);
+                g.semester = 1;
+                g.attendance_percent = exact ? percent(rng) / 100.0 : any(rng);
+                g.assignment_completion = exact ? percent(rng) / 100.0 : any(rng);
+                g.exam_result = 0;
+                columns.push(g);
+            }
+        }
+        return columns;
+    }
+
+    bool same(const Prediction& a, const Prediction& b) {
+        return a.student_id == b.student_id && a.has_data == b.has_data &&
+               std::memcmp(&a.score, &b.score, sizeof(double)) == 0 &&
+               a.predicted_grade == b.predicted_grade && a.probability == b.probability;
+    }
+
+    double elapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main() {
+    if (!Predictor::avx2Supported()) {
+        std::cout << "AVX2 не поддерживается процессором (или сборкой) - сравнивать не с чем" << std::endl;
+        return 0;
+    }
+
+    size_t checked = 0;
+    double scalarMs = 0.0;
+    double avx2Ms = 0.0;
+    for (int seed = 0; seed < SEEDS; seed++) {
+        std::mt19937_64 rng(seed);
+        for (size_t segments : SEGMENT_COUNTS) {
+            GradeColumns columns = makeColumns(segments, rng);
+
+            auto start = std::chrono::steady_clock::now();
+            std::vector<Prediction> scalar = Predictor::predictAll(columns, Predictor::Kernel::Scalar);
+            scalarMs += elapsedMs(start);
+            start = std::chrono::steady_clock::now();
+            std::vector<Prediction> avx2 = Predictor::predictAll(columns, Predictor::Kernel::Avx2);
+            avx2Ms += elapsedMs(start);
+
+            if (scalar.size() != avx2.size()) {
+                std::cout << "Расхождение: seed " << seed << ", студентов " << segments << ": "
+                          << scalar.size() << " прогнозов против " << avx2.size() << std::endl;
+                return 1;
+            }
+            for (size_t i = 0; i < scalar.size(); i++) {
+                if (!same(scalar[i], avx2[i])) {
+                    std::cout.precision(17);
+                    std::cout << "Расхождение: seed " << seed << ", студент " << scalar[i].student_id
+                              << ": score " << scalar[i].score << " (scalar) против " << avx2[i].score
+                              << " (avx2)" << std::endl;
+                    return 1;
+                }
+            }
+            checked += scalar.size();
+        }
+    }
+
+    std::cout << "Scalar и AVX2 совпадают побитово: " << checked << " прогнозов" << std::endl;
+    std::cout << "scalar: " << scalarMs << " мс, avx2: " << avx2Ms << " мс" << std::endl;
+    return 0;
+}
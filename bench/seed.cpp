@@ -0,0 +1,140 @@
+// Тестовые данные для нагрузочного теста: N студентов по M оценок в таблицах из
+// database/init.sql. Строки загружаются через COPY одной транзакцией; построчные
+// уведомления выключены (как при импорте), в конце серверы получают одно RELOAD.
+// Подключение - те же DB_HOST, DB_PORT, DB_NAME, DB_USER, DB_PASSWORD, что у сервера.
+// Сборка и запуск: make bench-seed ARGS="--students 1000 --grades 20 --reset 1"
+#include <pqxx/pqxx>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+    const char* const NAMES[] = {"Иван", "Мария", "Алексей", "Елена", "Дмитрий", "Анна", "Сергей", "Ольга"};
+    const char* const SURNAMES[] = {"Иванов", "Петрова", "Сидоров", "Козлова", "Смирнов", "Попова", "Волков", "Новикова"};
+    const char* const SUBJECTS[] = {"Математика", "Программирование", "Базы данных", "Физика",
+                                    "Английский язык", "Алгоритмы"};
+    const size_t GROUPS = 40;
+
+    std::string getEnvVar(const std::string& key, const std::string& defaultValue) {
+        const char* val = std::getenv(key.c_str());
+        return val ? std::string(val) : defaultValue;
+    }
+
+    // --name=value или --name value
+    std::string setting(int argc, char* argv[], const std::string& name, const std::string& defaultValue) {
+        std::string flag = "--" + name;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == flag && i + 1 < argc) {
+                return argv[i + 1];
+            }
+            if (arg.rfind(flag + "=", 0) == 0) {
+                return arg.substr(flag.size() + 1);
+            }
+        }
+        return defaultValue;
+    }
+
+    double clamp(double value, double low, double high) {
+        return value < low ? low : (value > high ? high : value);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t students = std::stoul(setting(argc, argv, "students", "1000"));
+    size_t grades_per_student = std::stoul(setting(argc, argv, "grades", "20"));
+    bool reset = setting(argc, argv, "reset", "0") != "0";
+    std::string init_sql = setting(argc, argv, "init", "");
+    std::mt19937_64 rng(std::stoull(setting(argc, argv, "seed", "42")));
+
+    std::string conn_str = "dbname=" + getEnvVar("DB_NAME", "exam_prediction") +
+                           " user=" + getEnvVar("DB_USER", "postgres") +
+                           " password=" + getEnvVar("DB_PASSWORD", "postgres") +
+                           " host=" + getEnvVar("DB_HOST", "localhost") +
+                           " port=" + getEnvVar("DB_PORT", "5432");
+    auto start = std::chrono::steady_clock::now();
+
+    try {
+        pqxx::connection conn(conn_str);
+
+        // --init database/init.sql: создать схему (на пустой базе)
+        if (!init_sql.empty()) {
+            std::ifstream file(init_sql);
+            if (!file) {
+                std::cerr << "Не удалось открыть " << init_sql << std::endl;
+                return 1;
+            }
+            std::stringstream sql;
+            sql << file.rdbuf();
+            pqxx::work txn(conn);
+            txn.exec(sql.str());
+            txn.commit();
+            std::cout << "Схема создана из " << init_sql << std::endl;
+        }
+
+        pqxx::work txn(conn);
+        // Без построчных pg_notify (см. notify_data_change в init.sql)
+        txn.exec("SELECT set_config('app.bulk_import', 'on', true)");
+        if (reset) {
+            // id студентов снова начинаются с 1 - нагрузочный тест выбирает их из 1..N
+            txn.exec("TRUNCATE student_grades, students RESTART IDENTITY CASCADE");
+        }
+        int last_id = txn.exec("SELECT COALESCE(MAX(id), 0) FROM students")[0][0].as<int>();
+
+        {
+            pqxx::stream_to stream(txn, "students", std::vector<std::string>{"name", "surname", "group_name"});
+            for (size_t i = 0; i < students; i++) {
+                std::string group = "ИТ-" + std::to_string(21 + i % GROUPS);
+                stream << std::make_tuple(std::string(NAMES[rng() % 8]), std::string(SURNAMES[rng() % 8]), group);
+            }
+            stream.complete();
+        }
+
+        std::vector<int> ids;
+        ids.reserve(students);
+        for (auto row : txn.exec("SELECT id FROM students WHERE id > " + std::to_string(last_id) + " ORDER BY id")) {
+            ids.push_back(row[0].as<int>());
+        }
+
+        std::normal_distribution<double> noise(0.0, 8.0);
+        std::uniform_real_distribution<double> ability(45.0, 100.0);
+        {
+            pqxx::stream_to stream(txn, "student_grades", std::vector<std::string>{
+                "student_id", "subject", "grade", "semester",
+                "attendance_percent", "assignment_completion", "exam_result"});
+            for (int id : ids) {
+                // Успеваемость студента задает и посещаемость, и оценки - прогнозу есть с чем работать
+                double level = ability(rng);
+                for (size_t g = 0; g < grades_per_student; g++) {
+                    double attendance = clamp(level + noise(rng), 0.0, 100.0);
+                    double assignment = clamp(level + noise(rng), 0.0, 100.0);
+                    int grade = (int)clamp((attendance + assignment) / 40.0 + 0.5, 2.0, 5.0);
+                    int exam_result = (int)clamp(grade + noise(rng) / 8.0 + 0.5, 2.0, 5.0);
+                    stream << std::make_tuple(id, std::string(SUBJECTS[g % 6]), grade, (int)(g / 6 % 8) + 1,
+                                              (int)(attendance * 100) / 100.0, (int)(assignment * 100) / 100.0,
+                                              exam_result);
+                }
+            }
+            stream.complete();
+        }
+
+        // Одно уведомление вместо построчных: серверы перечитают кэш целиком
+        txn.exec("SELECT pg_notify('data_changes', 'student_grades:RELOAD:0')");
+        txn.commit();
+    } catch (const std::exception& e) {
+        std::cerr << "Database error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Добавлено студентов: " << students << ", оценок: " << students * grades_per_student
+              << " за " << seconds << " с" << (reset ? " (таблицы очищены, id студентов 1.." + std::to_string(students) + ")" : "")
+              << std::endl;
+    return 0;
+}
@@ -33,6 +33,84 @@ CREATE TABLE IF NOT EXISTS student_grades (
     created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
 );
 
+-- Индексы для постраничной выдачи по ключу (WHERE фильтр = $1 AND id > $2 ORDER BY id LIMIT $3):
+-- страница читается из индекса с нужного места, без пропуска предыдущих строк
+CREATE INDEX IF NOT EXISTS idx_students_group_id ON students (group_name, id);
+CREATE INDEX IF NOT EXISTS idx_student_grades_student_id ON student_grades (student_id, id);
+CREATE INDEX IF NOT EXISTS idx_student_grades_subject_id ON student_grades (subject, id);
+CREATE INDEX IF NOT EXISTS idx_student_grades_semester_id ON student_grades (semester, id);
+
+-- Уведомления об изменениях студентов и оценок.
+-- Каждый экземпляр сервера слушает канал data_changes и обновляет свой кэш.
+-- Формат сообщения: <таблица>:<операция>:<id строки>:<экземпляр>:<транзакция>. Экземпляр -
+-- app.instance соединения, с которого сделано изменение (сервер задает его для своих
+-- соединений), транзакция - txid_current(): по ней сервер сопоставляет уведомление о своем
+-- изменении с поправкой кэша, которую он сделал сам сразу после коммита
+CREATE OR REPLACE FUNCTION notify_data_change() RETURNS trigger AS $$
+DECLARE
+    -- ':<экземпляр>:<транзакция>' в конце каждого сообщения
+    tail TEXT := ':' || COALESCE(current_setting('app.instance', true), '') || ':' || txid_current();
+BEGIN
+    -- Массовый импорт оценок выключает построчные уведомления в своей транзакции
+    -- и в конце отправляет одно сообщение student_grades:RELOAD:0:<экземпляр>
+    IF current_setting('app.bulk_import', true) = 'on' THEN
+        RETURN NULL;
+    END IF;
+    IF TG_LEVEL = 'STATEMENT' THEN
+        -- TRUNCATE: конкретных строк нет, кэш нужно сбросить целиком
+        PERFORM pg_notify('data_changes', TG_TABLE_NAME || ':' || TG_OP || ':0' || tail);
+    ELSIF TG_OP = 'DELETE' THEN
+        PERFORM pg_notify('data_changes', TG_TABLE_NAME || ':' || TG_OP || ':' || OLD.id || tail);
+    ELSE
+        PERFORM pg_notify('data_changes', TG_TABLE_NAME || ':' || TG_OP || ':' || NEW.id || tail);
+    END IF;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS students_notify ON students;
+CREATE TRIGGER students_notify
+    AFTER INSERT OR UPDATE OR DELETE ON students
+    FOR EACH ROW EXECUTE FUNCTION notify_data_change();
+
+DROP TRIGGER IF EXISTS students_notify_truncate ON students;
+CREATE TRIGGER students_notify_truncate
+    AFTER TRUNCATE ON students
+    FOR EACH STATEMENT EXECUTE FUNCTION notify_data_change();
+
+DROP TRIGGER IF EXISTS student_grades_notify ON student_grades;
+CREATE TRIGGER student_grades_notify
+    AFTER INSERT OR UPDATE OR DELETE ON student_grades
+    FOR EACH ROW EXECUTE FUNCTION notify_data_change();
+
+DROP TRIGGER IF EXISTS student_grades_notify_truncate ON student_grades;
+CREATE TRIGGER student_grades_notify_truncate
+    AFTER TRUNCATE ON student_grades
+    FOR EACH STATEMENT EXECUTE FUNCTION notify_data_change();
+
+-- Общий для всех экземпляров счетчик изменений студентов и оценок: из него строится ETag,
+-- когда кэш выключен. Последовательность, а не строка таблицы: nextval не берет блокировок
+-- до коммита, поэтому параллельные записи (в том числе импорт и пакеты группового коммита)
+-- друг друга не ждут. Счетчик увеличивается раз на оператор до коммита транзакции
+CREATE SEQUENCE IF NOT EXISTS data_version;
+
+CREATE OR REPLACE FUNCTION bump_data_version() RETURNS trigger AS $$
+BEGIN
+    PERFORM nextval('data_version');
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql;
+
+DROP TRIGGER IF EXISTS students_version ON students;
+CREATE TRIGGER students_version
+    AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON students
+    FOR EACH STATEMENT EXECUTE FUNCTION bump_data_version();
+
+DROP TRIGGER IF EXISTS student_grades_version ON student_grades;
+CREATE TRIGGER student_grades_version
+    AFTER INSERT OR UPDATE OR DELETE OR TRUNCATE ON student_grades
+    FOR EACH STATEMENT EXECUTE FUNCTION bump_data_version();
+
 -- Вставка тестовых данных
 -- ПРИМЕЧАНИЕ: Пароли автоматически хешируются при регистрации через приложение
 -- Для создания тестовых пользователей используйте интерфейс регистрации или выполните: